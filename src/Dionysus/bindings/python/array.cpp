@@ -0,0 +1,47 @@
+#define BOOST_PYTHON_STATIC_LIB
+#include <boost/python.hpp>
+namespace bp = boost::python;
+
+#include "array.h"
+namespace dp = dionysus::python;
+
+
+int
+dp::Array::
+get_buffer(PyObject* self, Py_buffer* view, int flags)
+{
+    if (flags & PyBUF_WRITABLE)
+    {
+        PyErr_SetString(PyExc_BufferError, "Array is read-only");
+        view->obj = 0;
+        return -1;
+    }
+
+    const Array& a = bp::extract<const Array&>(self);
+
+    Py_INCREF(self);
+    view->obj           = self;
+    view->buf           = a.data_;
+    view->len           = a.ndim_ == 2 ? a.shape_[0]*a.shape_[1]*a.itemsize_ : a.shape_[0]*a.itemsize_;
+    view->readonly      = 1;
+    view->itemsize      = a.itemsize_;
+    view->format        = (flags & PyBUF_FORMAT) ? const_cast<char*>(a.format_) : 0;
+    view->ndim          = a.ndim_;
+    view->shape         = (flags & PyBUF_ND)      ? const_cast<Py_ssize_t*>(a.shape_)   : 0;
+    view->strides       = (flags & PyBUF_STRIDES) ? const_cast<Py_ssize_t*>(a.strides_) : 0;
+    view->suboffsets    = 0;
+    view->internal      = 0;
+    return 0;
+}
+
+void export_array()
+{
+    bp::object array = bp::class_<dp::Array, dp::ArrayPtr, boost::noncopyable>("Array", bp::no_init)
+        .def("__len__",         &dp::Array::size)
+        .add_property("shape",  &dp::Array::shape)
+    ;
+
+    // Boost.Python has no way to declare the buffer protocol, so it goes straight into the type
+    static PyBufferProcs    buffer_procs = { &dp::Array::get_buffer, 0 };
+    reinterpret_cast<PyTypeObject*>(array.ptr())->tp_as_buffer = &buffer_procs;
+}
@@ -0,0 +1,177 @@
+#define BOOST_PYTHON_STATIC_LIB
+#ifndef __PYTHON_ARRAY_H__
+#define __PYTHON_ARRAY_H__
+
+#include <vector>
+
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/cstdint.hpp>
+namespace bp = boost::python;
+
+namespace dionysus {
+namespace python   {
+
+// Format character of the buffer protocol for T
+template<class T>   struct ArrayFormat;
+template<>          struct ArrayFormat<double>              { static const char* format() { return "d"; } };
+template<>          struct ArrayFormat<int>                 { static const char* format() { return "i"; } };
+template<>          struct ArrayFormat<unsigned>            { static const char* format() { return "I"; } };
+template<>          struct ArrayFormat<boost::int64_t>      { static const char* format() { return "q"; } };
+
+/**
+ * Array is a read-only, C-contiguous array of numbers (with one or two dimensions) that C++ hands to Python.
+ * It takes over the memory of a std::vector, and exposes it through the buffer protocol, so numpy.asarray()
+ * and memoryview() read it in place, without a Python object per element.
+ */
+class Array
+{
+    public:
+        // Takes over the contents of values (leaving it empty); with columns > 0 the array is
+        // values.size()/columns by columns
+        template<class T>
+                        Array(std::vector<T>& values, size_t columns = 0):
+                            itemsize_(sizeof(T)), format_(ArrayFormat<T>::format())
+        {
+            boost::shared_ptr< std::vector<T> > owner = boost::make_shared< std::vector<T> >();
+            owner->swap(values);
+            data_   = owner->empty() ? 0 : &(*owner)[0];
+            owner_  = owner;
+
+            ndim_       = columns > 0 ? 2 : 1;
+            shape_[0]   = ndim_ == 2 ? owner->size() / columns : owner->size();
+            shape_[1]   = columns;
+            strides_[0] = ndim_ == 2 ? columns*itemsize_ : itemsize_;
+            strides_[1] = itemsize_;
+        }
+
+        size_t          size() const                                        { return shape_[0]; }
+        bp::tuple       shape() const                                       { return ndim_ == 2 ? bp::make_tuple(shape_[0], shape_[1]) : bp::make_tuple(shape_[0]); }
+
+        // bf_getbuffer of the Python type (see export_array())
+        static int      get_buffer(PyObject* self, Py_buffer* view, int flags);
+
+    private:
+        boost::shared_ptr<void>     owner_;
+        void*                       data_;
+        Py_ssize_t                  itemsize_;
+        const char*                 format_;
+        int                         ndim_;
+        Py_ssize_t                  shape_[2];
+        Py_ssize_t                  strides_[2];
+};
+
+typedef         boost::shared_ptr<Array>                    ArrayPtr;
+
+template<class T>
+ArrayPtr        make_array(std::vector<T>& values, size_t columns = 0)      { return ArrayPtr(new Array(values, columns)); }
+
+// Copies the element at p (of the buffer format) into value; false if the format is not a plain number
+template<class T>
+bool            read_element(const char* format, const char* p, T& value)
+{
+    if (*format == '@' || *format == '=' || *format == '<' || *format == '>')
+        ++format;
+    if (format[0] == 0 || format[1] != 0)
+        return false;
+    switch (*format)
+    {
+        case 'b':   value = static_cast<T>(*reinterpret_cast<const signed char*>(p));           return true;
+        case 'B':   value = static_cast<T>(*reinterpret_cast<const unsigned char*>(p));         return true;
+        case 'h':   value = static_cast<T>(*reinterpret_cast<const short*>(p));                 return true;
+        case 'H':   value = static_cast<T>(*reinterpret_cast<const unsigned short*>(p));        return true;
+        case 'i':   value = static_cast<T>(*reinterpret_cast<const int*>(p));                   return true;
+        case 'I':   value = static_cast<T>(*reinterpret_cast<const unsigned*>(p));              return true;
+        case 'l':   value = static_cast<T>(*reinterpret_cast<const long*>(p));                  return true;
+        case 'L':   value = static_cast<T>(*reinterpret_cast<const unsigned long*>(p));         return true;
+        case 'q':   value = static_cast<T>(*reinterpret_cast<const long long*>(p));             return true;
+        case 'Q':   value = static_cast<T>(*reinterpret_cast<const unsigned long long*>(p));    return true;
+        case 'f':   value = static_cast<T>(*reinterpret_cast<const float*>(p));                 return true;
+        case 'd':   value = static_cast<T>(*reinterpret_cast<const double*>(p));                return true;
+        default:    return false;
+    }
+}
+
+// Fills values with the numbers of a Python sequence; a one-dimensional buffer of numbers (e.g., a numpy array, or an Array)
+// is read directly, anything else is iterated over
+template<class T>
+void            to_vector(bp::object o, std::vector<T>& values)
+{
+    values.clear();
+
+    Py_buffer view;
+    if (PyObject_CheckBuffer(o.ptr()) && PyObject_GetBuffer(o.ptr(), &view, PyBUF_STRIDES | PyBUF_FORMAT) == 0)
+    {
+        bool read = view.ndim == 1;
+        T value;
+        if (read && view.shape[0] > 0)
+            read = read_element(view.format, static_cast<const char*>(view.buf), value);
+        if (read)
+        {
+            values.resize(view.shape[0]);
+            for (Py_ssize_t i = 0; i < view.shape[0]; ++i)
+                read_element(view.format, static_cast<const char*>(view.buf) + i*view.strides[0], values[i]);
+        }
+        PyBuffer_Release(&view);
+        if (read)
+            return;
+    } else
+        PyErr_Clear();
+
+    for (bp::stl_input_iterator<bp::object> cur(o), end; cur != end; ++cur)
+        values.push_back(bp::extract<T>(*cur));
+}
+
+// Fills values with the rows (one after another) of a two-dimensional Python sequence, and returns the number of
+// its columns; a two-dimensional buffer of numbers is read directly, anything else is iterated over by rows
+template<class T>
+size_t          to_matrix(bp::object o, std::vector<T>& values)
+{
+    values.clear();
+
+    Py_buffer view;
+    if (PyObject_CheckBuffer(o.ptr()) && PyObject_GetBuffer(o.ptr(), &view, PyBUF_STRIDES | PyBUF_FORMAT) == 0)
+    {
+        bool read = view.ndim == 2;
+        T value;
+        if (read && view.shape[0] > 0 && view.shape[1] > 0)
+            read = read_element(view.format, static_cast<const char*>(view.buf), value);
+        size_t columns = read ? view.shape[1] : 0;
+        if (read)
+        {
+            values.resize(view.shape[0]*columns);
+            for (Py_ssize_t i = 0; i < view.shape[0]; ++i)
+                for (Py_ssize_t j = 0; j < view.shape[1]; ++j)
+                    read_element(view.format, static_cast<const char*>(view.buf) + i*view.strides[0] + j*view.strides[1],
+                                 values[i*columns + j]);
+        }
+        PyBuffer_Release(&view);
+        if (read)
+            return columns;
+    } else
+        PyErr_Clear();
+
+    size_t          columns = 0;
+    bool            first   = true;
+    std::vector<T>  row;
+    for (bp::stl_input_iterator<bp::object> cur(o), end; cur != end; ++cur)
+    {
+        to_vector(*cur, row);
+        if (first)
+            columns = row.size();
+        first = false;
+        if (row.size() != columns)
+        {
+            PyErr_SetString(PyExc_ValueError, "the rows must have the same length");
+            bp::throw_error_already_set();
+        }
+        values.insert(values.end(), row.begin(), row.end());
+    }
+    return columns;
+}
+
+} } // namespace dionysus::python
+
+#endif // __PYTHON_ARRAY_H__
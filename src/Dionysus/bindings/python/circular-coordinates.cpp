@@ -0,0 +1,207 @@
+#define BOOST_PYTHON_STATIC_LIB
+#include <topology/circular-coordinates.h>
+#include <utilities/timer.h>
+
+#include <limits>
+#include <algorithm>
+
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+#include <boost/shared_ptr.hpp>
+namespace bp = boost::python;
+
+#include "filtration.h"             // defines PythonFiltration
+#include "array.h"
+#include "utils.h"                  // for ScopedGILRelease
+namespace dp = dionysus::python;
+
+
+namespace dionysus {
+namespace python   {
+
+// CircularCoordinates of the simplices of a filtration with values below death; the cocycles can be smoothed
+// in the smaller complexes of its prefixes (the simplices below their own deaths)
+class PythonCircularCoordinates
+{
+    public:
+        typedef         CircularCoordinates::RealVector                     RealVector;
+
+                        PythonCircularCoordinates(const PythonFiltration& f, double death):
+                            edges_(1, 0), triangles_(1, 0), iterations_(0), time_(0)
+        {
+            // the filtration is sorted by the values, so the complex is its prefix
+            size_t vertices = 0;
+            for (PythonFiltration::Index cur = f.begin(); cur != f.end(); ++cur)
+            {
+                bp::extract<double> value(cur->data());
+                if (!value.check())
+                {
+                    PyErr_SetString(PyExc_TypeError, "the data of the simplices must be their values (numbers)");
+                    bp::throw_error_already_set();
+                }
+                if (value() >= death)
+                    break;
+                if (cur->vertices().empty() || cur->vertices().front() < 0)
+                {
+                    PyErr_SetString(PyExc_ValueError, "the vertices of the simplices must be non-negative");
+                    bp::throw_error_already_set();
+                }
+                vertices = std::max(vertices, static_cast<size_t>(cur->vertices().back()) + 1);
+                dimensions_.push_back(cur->dimension());
+                values_.push_back(value());
+                edges_.push_back(edges_.back() + (cur->dimension() == 1));
+                triangles_.push_back(triangles_.back() + (cur->dimension() == 2));
+            }
+
+            ScopedGILRelease    nogil;
+            coordinates_.reset(new CircularCoordinates(f.begin(), f.begin() + dimensions_.size(), vertices));
+        }
+
+        // Values of the vertices of the smoothing of the cocycle with the coefficients at the positions of the filtration,
+        // in the complex of the simplices below death
+        ArrayPtr        smooth(bp::object positions, bp::object coefficients, int prime, double death, bool precondition) const
+        {
+            std::vector<RealVector> z(1), x;
+            std::vector<size_t>     prefixes(1, prefix(death));
+            cochain(positions, coefficients, prime, prefixes[0], z[0]);
+            solve(z, x, prefixes, precondition);
+            return make_array(x[0]);
+        }
+
+        // Values of the vertices (a row per cocycle) of the smoothings of the sequence of cocycles, given as
+        // (positions, coefficients) or (positions, coefficients, death); all of them are solved together
+        ArrayPtr        smooth_all(bp::object cocycles, int prime, bool precondition) const
+        {
+            std::vector<RealVector> z;
+            std::vector<size_t>     prefixes;
+            for (bp::stl_input_iterator<bp::object> cur(cocycles), end; cur != end; ++cur)
+            {
+                bp::object  cocycle = *cur;
+                double      death   = bp::len(cocycle) > 2 ? bp::extract<double>(cocycle[2]) : std::numeric_limits<double>::infinity();
+                prefixes.push_back(prefix(death));
+                z.push_back(RealVector());
+                cochain(cocycle[0], cocycle[1], prime, prefixes.back(), z.back());
+            }
+
+            std::vector<RealVector> x;
+            solve(z, x, prefixes, precondition);
+
+            RealVector values;  values.reserve(x.size()*vertices());
+            for (size_t i = 0; i < x.size(); ++i)
+                values.insert(values.end(), x[i].begin(), x[i].end());
+            return make_array(values, vertices());
+        }
+
+        size_t          vertices() const                                    { return coordinates_->vertices(); }
+        size_t          edges() const                                       { return coordinates_->edges(); }
+        size_t          triangles() const                                   { return coordinates_->triangles(); }
+
+        // Number of the iterations and the time (in seconds) of the last smoothing
+        unsigned        iterations() const                                  { return iterations_; }
+        double          time() const                                        { return time_; }
+
+    private:
+        // Number of the simplices below death
+        size_t          prefix(double death) const                          { return std::lower_bound(values_.begin(), values_.end(), death) - values_.begin(); }
+
+        // Cochain z on the edges of the complex of the first simplices with the coefficients at the positions of the filtration
+        void            cochain(bp::object positions, bp::object coefficients, int prime, size_t simplices, RealVector& z) const
+        {
+            std::vector<unsigned>   p;  to_vector(positions, p);
+            std::vector<double>     c;  to_vector(coefficients, c);
+            if (p.size() != c.size())
+            {
+                PyErr_SetString(PyExc_ValueError, "positions and coefficients must have the same length");
+                bp::throw_error_already_set();
+            }
+
+            z.assign(coordinates_->edges(), 0);
+            for (size_t i = 0; i < p.size(); ++i)
+            {
+                if (p[i] >= simplices)                              // not in the complex
+                    continue;
+                if (dimensions_[p[i]] != 1)
+                {
+                    PyErr_SetString(PyExc_ValueError, "the cocycle must consist of edges");
+                    bp::throw_error_already_set();
+                }
+                double coefficient = c[i];
+                if (prime && coefficient > prime/2)                 // lift from Z_p into (-p/2, p/2]
+                    coefficient -= prime;
+                z[coordinates_->index(p[i])] = coefficient;
+            }
+        }
+
+        // Smooths the cocycles z[i] in the complexes of the first prefixes[i] simplices
+        void            solve(const std::vector<RealVector>& z, std::vector<RealVector>& x, const std::vector<size_t>& prefixes, bool precondition) const
+        {
+            std::vector<size_t>     edges;
+            for (size_t i = 0; i < prefixes.size(); ++i)
+                edges.push_back(edges_[prefixes[i]]);
+
+            bool    cocycles = true;
+            double  residual = 0;
+            {
+                ScopedGILRelease    nogil;
+                for (size_t i = 0; i < z.size(); ++i)
+                    cocycles &= coordinates_->cocycle(z[i], triangles_[prefixes[i]]);
+                if (cocycles)
+                {
+                    Timer   timer;  timer.start();
+                    iterations_ = coordinates_->smooth(z, x, edges, 1e-10, 0, precondition);
+                    timer.stop();
+                    time_ = timer.total();
+
+                    for (size_t i = 0; i < z.size(); ++i)
+                        residual = std::max(residual, coordinates_->residual(z[i], x[i], edges[i]));
+                }
+            }
+            if (!cocycles)
+            {
+                PyErr_SetString(PyExc_ValueError, "expected a cocycle as input");
+                bp::throw_error_already_set();
+            }
+            if (residual*residual >= 1e-10)
+            {
+                PyErr_SetString(PyExc_ArithmeticError, "expected a harmonic cocycle");
+                bp::throw_error_already_set();
+            }
+        }
+
+        boost::shared_ptr<CircularCoordinates>      coordinates_;
+        std::vector<Dimension>                      dimensions_;
+        std::vector<double>                         values_;
+        std::vector<unsigned>                       edges_;             // edges_[i] and triangles_[i] are the numbers of
+        std::vector<unsigned>                       triangles_;         // the edges and the triangles among the first i simplices
+        mutable unsigned                            iterations_;
+        mutable double                              time_;
+};
+} } // namespace dionysus::python
+
+
+boost::shared_ptr<dp::PythonCircularCoordinates>    init_from_filtration(const dp::PythonFiltration& f, double death)
+{
+    boost::shared_ptr<dp::PythonCircularCoordinates>    p(new dp::PythonCircularCoordinates(f, death));
+    return p;
+}
+
+boost::shared_ptr<dp::PythonCircularCoordinates>    init_from_filtration_all(const dp::PythonFiltration& f)
+{ return init_from_filtration(f, std::numeric_limits<double>::infinity()); }
+
+void export_circular_coordinates()
+{
+    bp::class_<dp::PythonCircularCoordinates>("CircularCoordinates", bp::no_init)
+        .def("__init__",        bp::make_constructor(&init_from_filtration))
+        .def("__init__",        bp::make_constructor(&init_from_filtration_all))
+
+        .def("smooth",          &dp::PythonCircularCoordinates::smooth, (bp::arg("positions"), bp::arg("coefficients"), bp::arg("prime")=0,
+                                                                         bp::arg("death")=std::numeric_limits<double>::infinity(),
+                                                                         bp::arg("precondition")=true))
+        .def("smooth_all",      &dp::PythonCircularCoordinates::smooth_all, (bp::arg("cocycles"), bp::arg("prime")=0, bp::arg("precondition")=true))
+        .def("vertices",        &dp::PythonCircularCoordinates::vertices)
+        .def("edges",           &dp::PythonCircularCoordinates::edges)
+        .def("triangles",       &dp::PythonCircularCoordinates::triangles)
+        .add_property("iterations", &dp::PythonCircularCoordinates::iterations)
+        .add_property("time",       &dp::PythonCircularCoordinates::time)
+    ;
+}
@@ -7,7 +7,12 @@
 #include <boost/shared_ptr.hpp>
 namespace bp = boost::python;
 
+#include <topology/simplex-key.h>
+
 #include "cohomology-persistence.h"             // defines CohomPersistence
+#include "filtration.h"                         // defines PythonFiltration
+#include "array.h"
+#include "utils.h"                              // for ScopedGILRelease
 #include "optional.h"
 namespace dp = dionysus::python;
 
@@ -15,6 +20,7 @@ namespace dp = dionysus::python;
 // CohomPersistence
 boost::shared_ptr<dp::CohomPersistence>     init_from_prime(unsigned p)
 {
+    dp::check_prime(p);
     dp::CohomPersistence::Field field(p);       // Zp
 
     boost::shared_ptr<dp::CohomPersistence> chp(new dp::CohomPersistence(field));
@@ -55,6 +61,163 @@ bp::tuple                                   chp_add(dp::CohomPersistence& chp,
 }
 
 
+namespace dionysus {
+namespace python   {
+
+// Position of the simplex in the filtration, stored with it in CohomologyPersistence
+struct FiltrationPosition
+{
+                    FiltrationPosition(unsigned p = 0): position(p)     {}
+    unsigned        position;
+};
+
+// Adds every simplex of a filtration to a native CohomologyPersistence over the field passed to operator()
+// (see with_zp_field()); nothing in here touches Python objects, so it runs without the GIL
+class AddFiltration
+{
+    public:
+                        AddFiltration(const PythonFiltration& filtration, const std::vector<double>& values,
+                                      size_t vertices, Dimension skeleton, Dimension dimension):
+                            filtration_(filtration), values_(values),
+                            vertices_(vertices), skeleton_(skeleton), dimension_(dimension)     {}
+
+        template<class Field>
+        void            operator()(const Field& field) const;
+
+        // (dimension, birth, death) of every class of non-zero persistence (death is infinity for the classes that
+        // never die), and the cocycles of the classes of the given dimension: the positions in the filtration of
+        // the simplices of the i-th one and their coefficients are in [offsets[i], offsets[i+1])
+        mutable std::vector<double>     pairs;
+        mutable std::vector<unsigned>   offsets, positions;
+        mutable std::vector<int>        coefficients;
+
+    private:
+        template<class ZColumn>
+        void            add_pair(Dimension d, double birth, double death, const ZColumn& zcolumn) const
+        {
+            pairs.push_back(d); pairs.push_back(birth); pairs.push_back(death);
+            if (d == dimension_)
+                for (typename ZColumn::const_iterator cur = zcolumn.begin(); cur != zcolumn.end(); ++cur)
+                {
+                    positions.push_back(cur->si->position);
+                    coefficients.push_back(cur->coefficient);
+                }
+            offsets.push_back(positions.size());
+        }
+
+        const PythonFiltration&         filtration_;
+        const std::vector<double>&      values_;
+        size_t                          vertices_;
+        Dimension                       skeleton_, dimension_;
+};
+
+template<class Field>
+void
+AddFiltration::
+operator()(const Field& field) const
+{
+    // births are the positions of the simplices in the filtration
+    typedef     CohomologyPersistence<unsigned, FiltrationPosition, Field, PooledStorage>   Persistence;
+    typedef     typename Persistence::SimplexIndex                                          Index;
+
+    Persistence                 persistence(field);
+    SimplexKeys                 keys(vertices_, skeleton_);
+    SimplexKeyMap<Index>        complex(skeleton_);
+    std::vector<SimplexKeys::Key>   facets(skeleton_ + 2);
+    std::vector<Index>          boundary;
+    std::vector<int>            signs;
+
+    offsets.push_back(0);
+    unsigned j = 0;
+    for (PythonFiltration::Index cur = filtration_.begin(); cur != filtration_.end(); ++cur, ++j)
+    {
+        const SimplexVD&    s = *cur;
+        Dimension           d = s.dimension();
+        if (d > skeleton_)
+            continue;
+
+        // the simplices that killed a class are cleared (see CohomologyPersistence::clear()), so they are left out
+        boundary.clear(); signs.clear();
+        if (d > 0)
+        {
+            keys.boundary(s.vertices().begin(), s.vertices().end(), facets.begin());
+            for (Dimension i = 0; i <= d; ++i)
+                if (const Index* facet = complex.find(d - 1, facets[i]))
+                {
+                    boundary.push_back(*facet);
+                    signs.push_back((i % 2) ? -1 : 1);
+                }
+        }
+
+        bool    store = d < skeleton_;
+        Index   si;
+        typename Persistence::Death         death;
+        typename Persistence::CocyclePtr    cocycle;
+        boost::tie(si, death, cocycle) = persistence.add(signs.begin(), boundary.begin(), boundary.end(),
+                                                         j, store, FiltrationPosition(j));
+        if (death)
+            persistence.clear(si);
+        else if (store)
+            complex.insert(d, keys.key(s.vertices().begin(), s.vertices().end()), si);
+
+        if (death && values_[j] > values_[*death])
+            add_pair(filtration_.simplex(filtration_.begin() + *death).dimension(), values_[*death], values_[j], *cocycle);
+    }
+
+    for (typename Persistence::CocycleIndex cur = persistence.begin(); cur != persistence.end(); ++cur)
+        add_pair(filtration_.simplex(filtration_.begin() + cur->birth).dimension(), values_[cur->birth], Infinity, cur->zcolumn);
+}
+
+} } // namespace dionysus::python
+
+// Static: the persistence runs in a CohomologyPersistence of its own (over Z_prime), so no instance is left out of date
+bp::tuple                                   chp_add_filtration(const dp::PythonFiltration& f,
+                                                               unsigned prime,
+                                                               Dimension skeleton,
+                                                               Dimension dimension)
+{
+    dp::check_prime(prime);
+
+    // everything that needs Python comes first: the values of the simplices, and the errors
+    std::vector<double>     values;     values.reserve(f.size());
+    size_t                  vertices = 0;
+    Dimension               max_dim  = 0;
+    for (dp::PythonFiltration::Index cur = f.begin(); cur != f.end(); ++cur)
+    {
+        bp::extract<double> value(cur->data());
+        if (!value.check())
+        {
+            PyErr_SetString(PyExc_TypeError, "the data of the simplices must be their values (numbers)");
+            bp::throw_error_already_set();
+        }
+        values.push_back(value());
+        if (cur->vertices().empty() || cur->vertices().front() < 0)
+        {
+            PyErr_SetString(PyExc_ValueError, "the vertices of the simplices must be non-negative");
+            bp::throw_error_already_set();
+        }
+        vertices = std::max(vertices, static_cast<size_t>(cur->vertices().back()) + 1);
+        max_dim  = std::max(max_dim, cur->dimension());
+    }
+    if (skeleton < 0)   skeleton  = max_dim;
+    if (dimension < 0)  dimension = skeleton - 1;
+    if (!SimplexKeys::fits(vertices, skeleton))
+    {
+        PyErr_SetString(PyExc_OverflowError, "keys of the simplices do not fit into 64 bits");
+        bp::throw_error_already_set();
+    }
+
+    dp::AddFiltration   add(f, values, vertices, skeleton, dimension);
+    {
+        dp::ScopedGILRelease    nogil;
+        with_zp_field(prime, add);
+    }
+
+    return bp::make_tuple(dp::make_array(add.pairs, 3), dp::make_array(add.offsets),
+                          dp::make_array(add.positions), dp::make_array(add.coefficients));
+}
+
+
 dp::CohomPersistence::ZColumn::const_iterator
 zcolumn_begin(dp::CohomPersistence::ZColumn& zcol)
 { return zcol.begin(); }
@@ -71,6 +234,29 @@ dp::CohomPersistence::ZColumn::const_iterator
 cocycle_zcolumn_end(dp::CohomPersistence::Cocycle& ccl)
 { return ccl.zcolumn.end(); }
 
+// Orders of the simplices and their coefficients in the column, as arrays
+dp::ArrayPtr                        zcolumn_orders(const dp::CohomPersistence::ZColumn& zcol)
+{
+    std::vector<unsigned>   orders;     orders.reserve(zcol.size());
+    for (dp::CohomPersistence::ZColumn::const_iterator cur = zcol.begin(); cur != zcol.end(); ++cur)
+        orders.push_back(cur->si->order);
+    return dp::make_array(orders);
+}
+
+dp::ArrayPtr                        zcolumn_coefficients(const dp::CohomPersistence::ZColumn& zcol)
+{
+    std::vector<int>        coefficients;   coefficients.reserve(zcol.size());
+    for (dp::CohomPersistence::ZColumn::const_iterator cur = zcol.begin(); cur != zcol.end(); ++cur)
+        coefficients.push_back(cur->coefficient);
+    return dp::make_array(coefficients);
+}
+
+dp::ArrayPtr                        cocycle_orders(const dp::CohomPersistence::Cocycle& ccl)
+{ return zcolumn_orders(ccl.zcolumn); }
+
+dp::ArrayPtr                        cocycle_coefficients(const dp::CohomPersistence::Cocycle& ccl)
+{ return zcolumn_coefficients(ccl.zcolumn); }
+
 // SimplexIndex
 template<class T>
 unsigned                            si_order(T& si)
@@ -96,6 +282,8 @@ void export_cohomology_persistence()
         .def("__init__",        bp::make_constructor(&init))
         .def("__init__",        bp::make_constructor(&init_from_prime))
         .def("add",             &chp_add, (bp::arg("bdry"), bp::arg("birth"), bp::arg("store")=true, bp::arg("image")=true, bp::arg("coefficients")=false))
+        .def("add_filtration",  &chp_add_filtration, (bp::arg("filtration"), bp::arg("prime")=11, bp::arg("skeleton")=-1, bp::arg("dimension")=-1))
+        .staticmethod("add_filtration")
 
         .def("__iter__",        bp::range(&dp::CohomPersistence::begin, &dp::CohomPersistence::end))
         .def("show_cocycles",   &dp::CohomPersistence::show_cocycles)
@@ -103,11 +291,15 @@ void export_cohomology_persistence()
 
     bp::class_<dp::CohomPersistence::Cocycle>("Cocycle", bp::no_init)
         .add_property("birth",  &dp::CohomPersistence::Cocycle::birth)
+        .def("orders",          &cocycle_orders)
+        .def("coefficients",    &cocycle_coefficients)
         .def("__iter__",        bp::range(&cocycle_zcolumn_begin, &cocycle_zcolumn_end))
     ;
 
     bp::class_<dp::CohomPersistence::ZColumn,
                boost::shared_ptr<dp::CohomPersistence::ZColumn> >("ZColumn", bp::no_init)
         .def("__iter__",        bp::range(&zcolumn_begin, &zcolumn_end))
+        .def("orders",          &zcolumn_orders)
+        .def("coefficients",    &zcolumn_coefficients)
     ;
 }
@@ -19,6 +19,11 @@ void export_persistence_diagram();
 
 void export_rips();
 void export_pairwise_distances();
+void export_simplex_key_map();
+void export_rips_cohomology();
+void export_array();
+void export_circular_coordinates();
+void export_harmonics();
 
 #ifndef NO_CGAL
 void export_alphashapes2d();
@@ -50,6 +55,11 @@ BOOST_PYTHON_MODULE(_dionysus)
 
     export_rips();
     export_pairwise_distances();
+    export_simplex_key_map();
+    export_rips_cohomology();
+    export_array();
+    export_circular_coordinates();
+    export_harmonics();
 
 #ifndef NO_CGAL
     export_alphashapes2d();
@@ -2,7 +2,11 @@
 #include <boost/python.hpp>
 namespace bp = boost::python;
 
+#include <geometry/gram-distances.h>
+
 #include "distances.h"
+#include "array.h"
+#include "utils.h"                  // for ScopedGILRelease
 namespace dp = dionysus::python;
 
 boost::shared_ptr<dp::ListPointPairwiseDistances>       init_from_list(bp::list lst)
@@ -11,6 +15,77 @@ boost::shared_ptr<dp::ListPointPairwiseDistances>       init_from_list(bp::list
     return p;
 }
 
+boost::shared_ptr<dp::ArrayDistances>                   init_from_array(bp::object array, bp::object periods)
+{
+    boost::shared_ptr<dp::ArrayDistances>               p(new dp::ArrayDistances(array, periods));
+    return p;
+}
+
+// ArrayDistances::operator() does not check the indices; from Python, they are checked here
+double                                                  array_distance(const dp::ArrayDistances& distances,
+                                                                       dp::ArrayDistances::IndexType a, dp::ArrayDistances::IndexType b)
+{
+    if (a >= distances.size() || b >= distances.size())
+    {
+        PyErr_SetString(PyExc_IndexError, "the index of a point is out of range");
+        bp::throw_error_already_set();
+    }
+    return distances(a, b);
+}
+
+// Condensed matrix of the Euclidean distances between the rows of points (see GramDistances)
+dp::ArrayPtr                                            condensed_distances(bp::object points, bool exact, unsigned threads)
+{
+    std::vector<double>     rows;
+    size_t                  dimension = dp::to_matrix(points, rows);
+    size_t                  n         = dimension ? rows.size() / dimension : bp::len(points);
+    std::vector<double>     distances;
+    {
+        dp::ScopedGILRelease    nogil;
+        GramDistances           gram(rows.empty() ? 0 : &rows[0], n, dimension, exact, threads);
+        distances = gram.condensed();
+    }
+    return dp::make_array(distances);
+}
+
+// Writes the distances into a file of MappedDistances, condensed, with the values of dtype ('float64' or 'float32'), and
+// their key()
+void                                                    save_distances(const dp::ArrayDistances& distances, const std::string& filename,
+                                                                       const std::string& dtype, unsigned threads)
+{
+    if (dtype != "float64" && dtype != "float32")
+    {
+        PyErr_SetString(PyExc_ValueError, "dtype must be 'float64' or 'float32'");
+        bp::throw_error_already_set();
+    }
+
+    std::string             error;
+    bool                    written;
+    {
+        dp::ScopedGILRelease    nogil;
+        written = MappedDistances::write(filename, distances,
+                                         dtype == "float64" ? MappedDistances::float64 : MappedDistances::float32,
+                                         MappedDistances::condensed, distances.key(), threads, &error);
+    }
+    if (!written)
+    {
+        PyErr_SetString(PyExc_IOError, error.c_str());
+        bp::throw_error_already_set();
+    }
+}
+
+// ArrayDistances of a file written by save_distances() (or MappedDistances::write()), mapped instead of read
+dp::ArrayDistances                                      open_distances(const std::string& filename)
+{
+    boost::shared_ptr<const MappedDistances>            mapped(new MappedDistances(filename));
+    if (!mapped->valid())
+    {
+        PyErr_SetString(PyExc_IOError, mapped->error().c_str());
+        bp::throw_error_already_set();
+    }
+    return dp::ArrayDistances(mapped);
+}
+
 void export_pairwise_distances()
 {
     bp::class_<dp::ListPointPairwiseDistances>("PairwiseDistances", bp::no_init)
@@ -18,5 +93,20 @@ void export_pairwise_distances()
         .def("__len__",         &dp::ListPointPairwiseDistances::size)
         .def("__call__",        &dp::ListPointPairwiseDistances::operator())
     ;
+
+    bp::class_<dp::ArrayDistances>("ArrayDistances", bp::no_init)
+        .def("__init__",        bp::make_constructor(&init_from_array, bp::default_call_policies(),
+                                                     (bp::arg("array"), bp::arg("periods")=bp::object())))
+        .def("__len__",         &dp::ArrayDistances::size)
+        .def("__call__",        &array_distance)
+        .def("dimension",       &dp::ArrayDistances::dimension)
+        .def("periods",         &dp::ArrayDistances::periods)
+        .def("key",             &dp::ArrayDistances::key)
+        .def("save",            &save_distances, (bp::arg("filename"), bp::arg("dtype")="float64", bp::arg("threads")=0))
+        .def("open",            &open_distances)
+        .staticmethod("open")
+    ;
+
+    bp::def("condensed_distances",  &condensed_distances, (bp::arg("points"), bp::arg("exact")=false, bp::arg("threads")=0));
 }
 
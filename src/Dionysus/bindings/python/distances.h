@@ -1,9 +1,20 @@
 #define BOOST_PYTHON_STATIC_LIB
+#ifndef __PYTHON_DISTANCES_H__
+#define __PYTHON_DISTANCES_H__
+
 #include <utilities/log.h>
+#include <geometry/periodic-distance.h>
+#include <geometry/mapped-distances.h>
+
+#include <vector>
+#include <cmath>
 
 #include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
 namespace bp = boost::python;
 
+#include "array.h"
+
 namespace dionysus { 
 namespace python   {
 
@@ -51,5 +62,184 @@ class ListPointPairwiseDistances
         Distance            distance_;
 };
 
+/**
+ * ArrayDistances are read from a buffer (e.g., a numpy array) once, and evaluated in C++ without touching Python:
+ * either the Euclidean distances between the rows of a two-dimensional array of points, or the distances of a condensed
+ * distance matrix, the one-dimensional array of d(i,j) for i < j in the row-major order (as scipy.spatial.distance.pdist()
+ * returns it). The values are shared between the copies, so copying is cheap. The points may also have periodic coordinates
+ * (e.g., Euler angles), whose differences are taken the shorter way around the circle (see periodic_squared_distance()).
+ * Finally, the distances may stay on disk, in a file of MappedDistances, which is then mapped instead of read.
+ */
+class ArrayDistances
+{
+    public:
+        typedef             unsigned                                        IndexType;
+        typedef             double                                          DistanceType;
+
+                            // periods is None (Euclidean), a number (the period of all the coordinates), or a period per coordinate
+                            // (0 for the Euclidean ones)
+                            ArrayDistances(bp::object array, bp::object periods = bp::object()):
+                                dimension_(0)
+        {
+            boost::shared_ptr< std::vector<DistanceType> >  values(new std::vector<DistanceType>);
+            if (bp::len(array) == 0)
+            {
+                PyErr_SetString(PyExc_ValueError, "the array of the points (or of the distances) is empty");
+                bp::throw_error_already_set();
+            }
+            if (ndim(array) == 2)
+            {
+                dimension_ = to_matrix(array, *values);
+                if (dimension_ == 0)
+                {
+                    PyErr_SetString(PyExc_ValueError, "the points must have coordinates");
+                    bp::throw_error_already_set();
+                }
+                size_      = values->size() / dimension_;
+            } else
+            {
+                to_vector(array, *values);
+                size_t  m = values->size();
+                size_      = static_cast<IndexType>((1 + std::sqrt(1 + 8.*m))/2 + .5);
+                if (static_cast<size_t>(size_)*(size_ - 1)/2 != m)
+                {
+                    PyErr_SetString(PyExc_ValueError, "the length of a condensed distance matrix must be n*(n-1)/2");
+                    bp::throw_error_already_set();
+                }
+            }
+            values_ = values;
+
+            if (!periods.is_none())
+                set_periods(periods);
+        }
+
+                            // The distances of a file written by MappedDistances::write() (see save())
+                            ArrayDistances(boost::shared_ptr<const MappedDistances> mapped):
+                                size_(mapped->size()), dimension_(0), mapped_(mapped)      {}
+
+        DistanceType        operator()(IndexType a, IndexType b) const
+        {
+            if (a == b)
+                return 0;
+            if (mapped_)
+                return (*mapped_)(a, b);
+            const std::vector<DistanceType>& v = *values_;
+            if (dimension_ == 0)
+            {
+                if (a > b) std::swap(a, b);
+                return v[static_cast<size_t>(a)*size_ - static_cast<size_t>(a)*(a + 1)/2 + (b - a - 1)];
+            }
+
+            const DistanceType* p = &v[static_cast<size_t>(a)*dimension_];
+            const DistanceType* q = &v[static_cast<size_t>(b)*dimension_];
+            if (periods_)
+                return std::sqrt(periodic_squared_distance(p, q, &(*periods_)[0], &(*periods_)[dimension_], dimension_));
+
+            DistanceType sum = 0;
+            for (size_t i = 0; i < dimension_; ++i)
+                sum += (p[i] - q[i])*(p[i] - q[i]);
+            return std::sqrt(sum);
+        }
+
+        size_t              size() const                                    { return size_; }
+        IndexType           begin() const                                   { return 0; }
+        IndexType           end() const                                     { return size(); }
+
+        // Dimension of the points; 0 for a condensed distance matrix (or a file of them)
+        size_t              dimension() const                               { return dimension_; }
+
+        // The coordinates of the points, a row per point (0 for a condensed distance matrix), and whether any of them is periodic
+        const DistanceType* coordinates() const                             { return dimension_ && size_ ? &(*values_)[0] : 0; }
+        bool                periodic() const                                { return periods_.get() != 0; }
+
+        // Periods of the coordinates (all 0 without any)
+        bp::list            periods() const
+        {
+            bp::list result;
+            for (size_t k = 0; k < dimension_; ++k)
+                result.append(periods_ ? (*periods_)[k] : 0.);
+            return result;
+        }
+
+        // A hash (FNV-1a) of the number of the points, the values, and the periods, which tells the distances apart, e.g.,
+        // in a file of MappedDistances (see save()); the distances of a file have the key stored in it
+        uint64_t            key() const
+        {
+            if (mapped_)
+                return mapped_->key();
+
+            uint64_t    h = 14695981039346656037ULL;
+            uint64_t    n = size_, dimension = dimension_;
+            hash(h, &n, sizeof(n));
+            hash(h, &dimension, sizeof(dimension));
+            hash(h, values_->empty() ? 0 : &(*values_)[0], values_->size()*sizeof(DistanceType));
+            if (periods_)
+                hash(h, &(*periods_)[0], dimension_*sizeof(DistanceType));
+            return h;
+        }
+
+    private:
+        static void         hash(uint64_t& h, const void* data, size_t bytes)
+        {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < bytes; ++i)
+            {
+                h ^= p[i];
+                h *= 1099511628211ULL;
+            }
+        }
+
+        void                set_periods(bp::object periods)
+        {
+            std::vector<DistanceType>   p;
+            bp::extract<DistanceType>   period(periods);
+            if (period.check())
+                p.assign(dimension_, period());
+            else
+                to_vector(periods, p);
+
+            if (dimension_ == 0 || p.size() != dimension_)
+            {
+                PyErr_SetString(PyExc_ValueError, "periods must be given for the points, one per coordinate (or one for all of them)");
+                bp::throw_error_already_set();
+            }
+
+            // the periods followed by their inverses
+            boost::shared_ptr< std::vector<DistanceType> >  values(new std::vector<DistanceType>(p));
+            for (size_t k = 0; k < dimension_; ++k)
+            {
+                if (p[k] < 0)
+                {
+                    PyErr_SetString(PyExc_ValueError, "the periods must be non-negative");
+                    bp::throw_error_already_set();
+                }
+                values->push_back(p[k] > 0 ? 1/p[k] : 0);
+            }
+            periods_ = values;
+        }
+
+        // Number of the dimensions of a buffer, or 2 for a sequence of sequences (and 1 otherwise)
+        static int          ndim(bp::object array)
+        {
+            Py_buffer view;
+            if (PyObject_CheckBuffer(array.ptr()) && PyObject_GetBuffer(array.ptr(), &view, PyBUF_STRIDES | PyBUF_FORMAT) == 0)
+            {
+                int n = view.ndim;
+                PyBuffer_Release(&view);
+                return n;
+            }
+            PyErr_Clear();
+            return bp::len(array) > 0 && PySequence_Check(bp::object(array[0]).ptr()) ? 2 : 1;
+        }
+
+        IndexType                                           size_;
+        size_t                                              dimension_;
+        boost::shared_ptr<const std::vector<DistanceType> > values_;
+        boost::shared_ptr<const std::vector<DistanceType> > periods_;
+        boost::shared_ptr<const MappedDistances>            mapped_;
+};
+
 } }     // namespace dionysus::python
 
+#endif // __PYTHON_DISTANCES_H__
+
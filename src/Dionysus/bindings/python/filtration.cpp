@@ -10,6 +10,7 @@ namespace bp = boost::python;
 #include "simplex.h"
 #include "filtration.h"      // defines PythonFiltration
 #include "utils.h"           // defines PythonCmp
+#include "array.h"
 namespace dp = dionysus::python;
 
 boost::shared_ptr<dp::PythonFiltration>     init_from_iterator(bp::object iter)
@@ -43,6 +44,30 @@ const dp::PythonFiltration::Simplex&        f_getitem(const dp::PythonFiltration
 unsigned                                    f_call(const dp::PythonFiltration& f, const dp::PythonFiltration::Simplex& s)
 { return f.find(s) - f.begin(); }
 
+// Data of the simplices as numbers, in the filtration order
+dp::ArrayPtr                                f_values(const dp::PythonFiltration& f)
+{
+    std::vector<double>     values;     values.reserve(f.size());
+    for (dp::PythonFiltration::Index cur = f.begin(); cur != f.end(); ++cur)
+    {
+        bp::extract<double> value(cur->data());
+        if (!value.check())
+        {
+            PyErr_SetString(PyExc_TypeError, "the data of the simplices must be their values (numbers)");
+            bp::throw_error_already_set();
+        }
+        values.push_back(value());
+    }
+    return dp::make_array(values);
+}
+
+dp::ArrayPtr                                f_dimensions(const dp::PythonFiltration& f)
+{
+    std::vector<int>        dimensions; dimensions.reserve(f.size());
+    for (dp::PythonFiltration::Index cur = f.begin(); cur != f.end(); ++cur)
+        dimensions.push_back(cur->dimension());
+    return dp::make_array(dimensions);
+}
 
 void export_filtration()
 {
@@ -57,5 +82,7 @@ void export_filtration()
         .def("__call__",        &f_call)
         .def("__iter__",        bp::range<bp::return_internal_reference<1> >(&dp::PythonFiltration::begin, &dp::PythonFiltration::end))
         .def("__len__",         &dp::PythonFiltration::size)
+        .def("values",          &f_values)
+        .def("dimensions",      &f_dimensions)
     ;
 }
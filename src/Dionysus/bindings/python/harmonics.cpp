@@ -0,0 +1,49 @@
+#define BOOST_PYTHON_STATIC_LIB
+#include <geometry/harmonics.h>
+
+#include <boost/python.hpp>
+namespace bp = boost::python;
+
+#include "array.h"
+#include "utils.h"                  // for ScopedGILRelease
+namespace dp = dionysus::python;
+
+
+typedef     Harmonics<double>                       PythonHarmonics;
+
+// Matrix of the (derivatives of the) first count harmonics at the samples t, a row per sample
+dp::ArrayPtr                harmonics_matrix(bp::object t, unsigned count, unsigned derivative)
+{
+    std::vector<double>     samples;    dp::to_vector(t, samples);
+    std::vector<double>     values;
+    {
+        dp::ScopedGILRelease    nogil;
+        PythonHarmonics(count, derivative).matrix(samples, values);
+    }
+    return dp::make_array(values, 2*count);
+}
+
+// Linear combination of the (derivatives of the) first count harmonics with the coefficients at the samples t
+dp::ArrayPtr                harmonics_combination(bp::object t, unsigned count, bp::object coefficients, unsigned derivative)
+{
+    std::vector<double>     samples;    dp::to_vector(t, samples);
+    std::vector<double>     c;          dp::to_vector(coefficients, c);
+    if (c.size() < 2*count)
+    {
+        PyErr_SetString(PyExc_ValueError, "expected 2*count coefficients");
+        bp::throw_error_already_set();
+    }
+
+    std::vector<double>     values;
+    {
+        dp::ScopedGILRelease    nogil;
+        PythonHarmonics(count, derivative).combination(samples, c, values);
+    }
+    return dp::make_array(values);
+}
+
+void export_harmonics()
+{
+    bp::def("harmonics",                &harmonics_matrix,      (bp::arg("t"), bp::arg("count"), bp::arg("derivative")=0));
+    bp::def("harmonics_combination",    &harmonics_combination, (bp::arg("t"), bp::arg("count"), bp::arg("coefficients"), bp::arg("derivative")=0));
+}
@@ -0,0 +1,179 @@
+#define BOOST_PYTHON_STATIC_LIB
+#include <topology/rips-cohomology.h>
+
+#include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+namespace bp = boost::python;
+
+#include "rips.h"                   // for RipsWithDistances::DistancesWrapper
+#include "array.h"
+#include "utils.h"                  // for ScopedGILRelease
+namespace dp = dionysus::python;
+
+
+namespace dionysus {
+namespace python   {
+
+// Stores the streamed filtration (only the neighbor graph), so the Python distances are evaluated once
+class PythonRipsCohomology
+{
+    public:
+        typedef         RipsWithDistances::DistancesWrapper                 DistancesWrapper;
+        typedef         StreamedRipsFiltration<DistancesWrapper>            Filtration;
+        typedef         Filtration::DistanceType                            DistanceType;
+
+                        PythonRipsCohomology(bp::object distances, Dimension skeleton, DistanceType max, unsigned prime):
+                            distances_(distances), filtration_(distances_, skeleton, max), prime_(prime)    {}
+
+        // Returns the list of (birth, death, cocycle) of the classes of dimension d with non-zero persistence
+        // (death is infinity for the classes that never die), where cocycle is the list of (coefficient, vertices)
+        bp::list        compute(Dimension d) const
+        {
+            boost::mutex::scoped_lock   lock(mutex_);
+            bp::list    result;
+            with_zp_field(prime_, Compute(result, filtration_, d));
+            return result;
+        }
+
+        // Same as compute(), but without the GIL, and with the result in the tuple of arrays (pairs, offsets, vertices, coefficients):
+        // pairs has a row (birth, death) for every class, and the simplices of the i-th cocycle are the rows
+        // offsets[i], ..., offsets[i+1] - 1 of vertices (d+1 vertices each), with the same entries of coefficients
+        bp::tuple       compute_arrays(Dimension d) const
+        {
+            ComputeArrays   arrays(filtration_, d);
+            {
+                ScopedGILRelease            nogil;
+                boost::mutex::scoped_lock   lock(mutex_);       // the filtration is not reentrant (see StreamedRipsFiltration::sweep_)
+                with_zp_field(prime_, arrays);
+            }
+            return bp::make_tuple(make_array(arrays.pairs, 2), make_array(arrays.offsets),
+                                  make_array(arrays.vertices, d + 1), make_array(arrays.coefficients));
+        }
+
+        size_t          edges() const                                       { return filtration_.graph().edges(); }
+
+    private:
+        template<class ZColumn>
+        static bp::list cocycle(const Filtration& filtration, Dimension d, const ZColumn& zcolumn)
+        {
+            bp::list                result;
+            std::vector<unsigned>   vertices(d + 1);
+            for (typename ZColumn::const_iterator cur = zcolumn.begin(); cur != zcolumn.end(); ++cur)
+            {
+                filtration.vertices(cur->si->key, d, vertices.begin());
+                bp::list v;
+                for (size_t i = 0; i < vertices.size(); ++i)
+                    v.append(vertices[i]);
+                result.append(bp::make_tuple(cur->coefficient, bp::tuple(v)));
+            }
+            return result;
+        }
+
+        struct AppendPair
+        {
+                        AppendPair(bp::list& result, const Filtration& filtration, Dimension d):
+                            result_(result), filtration_(filtration), d_(d) {}
+
+            template<class ZColumn>
+            void        operator()(Dimension d, DistanceType birth, DistanceType death, const ZColumn& zcolumn) const
+            {
+                if (d == d_ && death > birth)
+                    result_.append(bp::make_tuple(birth, death, cocycle(filtration_, d, zcolumn)));
+            }
+
+            bp::list&           result_;
+            const Filtration&   filtration_;
+            Dimension           d_;
+        };
+
+        // Runs the computation over the field chosen by with_zp_field()
+        struct Compute: public AppendPair
+        {
+                        Compute(bp::list& result, const Filtration& filtration, Dimension d):
+                            AppendPair(result, filtration, d)               {}
+
+            template<class Field>
+            void        operator()(const Field& field) const
+            {
+                typedef     RipsCohomology<DistancesWrapper, Field>         Cohomology;
+                Cohomology  cohomology(this->filtration_, field);
+                cohomology.compute(static_cast<const AppendPair&>(*this));
+
+                for (typename Cohomology::CocycleIndex cur = cohomology.begin(); cur != cohomology.end(); ++cur)
+                    if (cur->birth.template get<0>() == this->d_)
+                        this->result_.append(bp::make_tuple(cur->birth.template get<1>(), Infinity,
+                                                            cocycle(this->filtration_, this->d_, cur->zcolumn)));
+            }
+        };
+
+        // Collects the classes of dimension d into arrays; touches no Python objects
+        struct ComputeArrays
+        {
+                        ComputeArrays(const Filtration& filtration, Dimension d):
+                            filtration_(filtration), d_(d)                  { offsets.push_back(0); }
+
+            template<class Field>
+            void        operator()(const Field& field) const
+            {
+                typedef     RipsCohomology<DistancesWrapper, Field>         Cohomology;
+                Cohomology  cohomology(filtration_, field);
+                cohomology.compute(*this);
+
+                for (typename Cohomology::CocycleIndex cur = cohomology.begin(); cur != cohomology.end(); ++cur)
+                    if (cur->birth.template get<0>() == d_)
+                        (*this)(d_, cur->birth.template get<1>(), Infinity, cur->zcolumn);
+            }
+
+            template<class ZColumn>
+            void        operator()(Dimension d, DistanceType birth, DistanceType death, const ZColumn& zcolumn) const
+            {
+                if (d != d_ || death <= birth)
+                    return;
+
+                pairs.push_back(birth); pairs.push_back(death);
+                for (typename ZColumn::const_iterator cur = zcolumn.begin(); cur != zcolumn.end(); ++cur)
+                {
+                    size_t  n = vertices.size();
+                    vertices.resize(n + d + 1);
+                    filtration_.vertices(cur->si->key, d, vertices.begin() + n);
+                    coefficients.push_back(cur->coefficient);
+                }
+                offsets.push_back(coefficients.size());
+            }
+
+            mutable std::vector<DistanceType>   pairs;
+            mutable std::vector<unsigned>       offsets, vertices;
+            mutable std::vector<int>            coefficients;
+
+            const Filtration&   filtration_;
+            Dimension           d_;
+        };
+
+        DistancesWrapper        distances_;
+        Filtration              filtration_;
+        unsigned                prime_;
+        mutable boost::mutex    mutex_;
+};
+
+} } // namespace dionysus::python
+
+
+boost::shared_ptr<dp::PythonRipsCohomology>     init_from_distances(bp::object distances, Dimension skeleton, 
+                                                                    dp::PythonRipsCohomology::DistanceType max, unsigned prime)
+{
+    dp::check_prime(prime);
+    boost::shared_ptr<dp::PythonRipsCohomology> p(new dp::PythonRipsCohomology(distances, skeleton, max, prime));
+    return p;
+}
+
+void export_rips_cohomology()
+{
+    bp::class_<dp::PythonRipsCohomology, boost::shared_ptr<dp::PythonRipsCohomology>, boost::noncopyable>("RipsCohomology", bp::no_init)
+        .def("__init__",        bp::make_constructor(&init_from_distances, bp::default_call_policies(),
+                                                     (bp::arg("distances"), bp::arg("skeleton"), bp::arg("max"), bp::arg("prime")=11)))
+        .def("compute",         &dp::PythonRipsCohomology::compute)
+        .def("compute_arrays",  &dp::PythonRipsCohomology::compute_arrays)
+        .def("edges",           &dp::PythonRipsCohomology::edges)
+    ;
+}
@@ -23,6 +23,11 @@ void export_rips()
         .def("__init__",            bp::make_constructor(&init_from_distances))
         .def("generate",            &dp::RipsWithDistances::generate)
         .def("generate",            &dp::RipsWithDistances::generate_candidates)
+        .def("generate_parallel",   &dp::RipsWithDistances::generate_parallel,
+                                    (bp::arg("k"), bp::arg("max"), bp::arg("functor"), bp::arg("threads")=0, bp::arg("ordered")=true))
+        .def("generate_graph",      &dp::RipsWithDistances::generate_graph)
+        .def("generate_with_values",&dp::RipsWithDistances::generate_with_values)
+        .def("generate_sorted",     &dp::RipsWithDistances::generate_sorted)
         .def("vertex_cofaces",      &dp::RipsWithDistances::vertex_cofaces)
         .def("vertex_cofaces",      &dp::RipsWithDistances::vertex_cofaces_candidate)
         .def("edge_cofaces",        &dp::RipsWithDistances::edge_cofaces)
@@ -3,12 +3,18 @@
 #define __PYTHON_RIPS_H__
 
 #include <topology/rips.h>
+#include <geometry/kd-tree.h>
 #include <utilities/indirect.h>
 
 #include "simplex.h"
+#include "distances.h"              // for ArrayDistances
+#include "utils.h"                  // for ScopedGILRelease, PythonError
+
+#include <utilities/containers.h>   // for PushBackFunctor
 
 #include <boost/python.hpp>
 #include <boost/python/stl_iterator.hpp>
+#include <boost/shared_ptr.hpp>
 
 
 namespace bp = boost::python;
@@ -23,6 +29,8 @@ namespace python   {
 class RipsWithDistances
 {
     public:
+        // Evaluates the distances by calling the Python object, unless it is an ArrayDistances, which is evaluated directly
+        // (so the native distances never go through the interpreter, nor need the GIL)
         class DistancesWrapper
         {
             public:
@@ -30,16 +38,55 @@ class RipsWithDistances
                 typedef             double                                          DistanceType;
         
                                     DistancesWrapper(bp::object distances):
-                                        distances_(distances)                       {}
+                                        distances_(distances), native_(0)
+                {
+                    bp::extract<const ArrayDistances&> native(distances);
+                    if (native.check())
+                        native_ = &native();                                        // distances_ keeps it alive
+                }
         
-                DistanceType        operator()(IndexType a, IndexType b) const      { return bp::extract<DistanceType>(distances_(a, b)); }
+                DistanceType        operator()(IndexType a, IndexType b) const
+                {
+                    if (native_)
+                        return (*native_)(a, b);
+                    return bp::extract<DistanceType>(distances_(a, b));
+                }
         
-                IndexType           size() const                                    { return bp::len(distances_); }
+                IndexType           size() const                                    { return native_ ? native_->size() : bp::len(distances_); }
                 IndexType           begin() const                                   { return 0; }
                 IndexType           end() const                                     { return size(); }
+
+                bool                native() const                                  { return native_; }
+                const ArrayDistances*   array() const                               { return native_; }
         
             private:
                 bp::object          distances_;
+                const ArrayDistances*   native_;
+        };
+
+        // Used from the worker threads of generate_parallel(), so it acquires the GIL for every Python distance;
+        // an exception raised by the distances is thrown as PythonError, since the worker's Python state goes with the GIL
+        class LockingDistancesWrapper: public DistancesWrapper
+        {
+            public:
+                                    LockingDistancesWrapper(const DistancesWrapper& distances):
+                                        DistancesWrapper(distances)                 {}
+
+                DistanceType        operator()(IndexType a, IndexType b) const
+                {
+                    if (native())
+                        return DistancesWrapper::operator()(a, b);
+
+                    ScopedGILAcquire gil;
+                    try
+                    {
+                        return DistancesWrapper::operator()(a, b);
+                    }
+                    catch (const bp::error_already_set&)
+                    {
+                        throw PythonError();
+                    }
+                }
         };
 
         typedef             DistancesWrapper::IndexType                             IndexType;
@@ -62,6 +109,21 @@ class RipsWithDistances
         };
 
 
+        // Stores the value of the simplex as its data
+        class ValueFunctorWrapper
+        {
+            public:
+                                    ValueFunctorWrapper(bp::object functor):
+                                        functor_(functor)                           {}
+
+                void                operator()(const RipsDS::View& v, DistanceType value) const
+                { functor_(SimplexVD(v.begin(), v.end(), bp::object(value))); }
+
+            private:
+                bp::object          functor_;
+        };
+
+
                             RipsWithDistances(bp::object distances):
                                 distances_(distances), rips_(distances_),
                                 cmp_(Comparison(distances_)), eval_(distances_)     {}
@@ -69,6 +131,52 @@ class RipsWithDistances
         void                generate(Dimension k, DistanceType max, bp::object functor) const
         { rips_.generate(k, max, FunctorWrapper(functor)); }
 
+        // Simplices are generated without the GIL (into a buffer of simplices without Python data), 
+        // and handed to functor afterwards
+        void                generate_parallel(Dimension k, DistanceType max, bp::object functor, unsigned threads, bool ordered) const
+        {
+            typedef         Rips<LockingDistancesWrapper, Simplex<IndexType> >      RipsLocking;
+            typedef         std::vector<RipsLocking::Simplex>                       SimplexVector;
+
+            LockingDistancesWrapper distances(distances_);
+            RipsLocking             rips(distances);
+            SimplexVector           simplices;
+            IndexType               n = distances_.size();
+            try
+            {
+                ScopedGILRelease    nogil;
+                rips.generate_parallel(k, max, make_push_back_functor(simplices), 
+                                       boost::make_counting_iterator(IndexType(0)), boost::make_counting_iterator(n), 
+                                       threads, ordered);
+            }
+            catch (const PythonError& error)                // rethrown by parallel_for() once all the workers are done
+            {
+                error.restore();
+                bp::throw_error_already_set();
+            }
+
+            for (SimplexVector::const_iterator cur = simplices.begin(); cur != simplices.end(); ++cur)
+                functor(SimplexVD(cur->vertices().begin(), cur->vertices().end()));
+        }
+
+        // Every distance is evaluated once (to build the neighbor graph), instead of at every level of the recursion
+        void                generate_graph(Dimension k, DistanceType max, bp::object functor) const
+        {
+            rips_.generate(k, *graph(max), FunctorWrapper(functor));
+        }
+
+        // Same as generate_graph(), but the values of the simplices (see eval()) are computed along the way
+        void                generate_with_values(Dimension k, DistanceType max, bp::object functor) const
+        {
+            rips_.generate_with_values(k, *graph(max), ValueFunctorWrapper(functor));
+        }
+
+        // Same as generate_with_values(), but the simplices come in the filtration order (see Rips::generate_sorted())
+        void                generate_sorted(Dimension k, DistanceType max, bp::object functor) const
+        {
+            rips_.generate_sorted(k, *graph(max), ValueFunctorWrapper(functor));
+        }
+
         void                vertex_cofaces(IndexType v, Dimension k, DistanceType max, bp::object functor) const
         { rips_.vertex_cofaces(v, k, max, FunctorWrapper(functor)); }
         
@@ -102,6 +210,23 @@ class RipsWithDistances
         DistanceType        eval_native(const SimplexVD& s) const                                           { return eval_(s); }
         
     private:
+        // The neighbor graph of the edges within max; the native distances are evaluated without the GIL, on all the cores,
+        // and for the Euclidean points only the pairs a KDTree finds within max are
+        boost::shared_ptr<RipsDS::Graph>
+                            graph(DistanceType max) const
+        {
+            if (!distances_.native())
+                return boost::shared_ptr<RipsDS::Graph>(new RipsDS::Graph(distances_, max));
+
+            ScopedGILRelease        nogil;
+            const ArrayDistances&   array = *distances_.array();
+            if (!array.coordinates() || array.periodic())
+                return boost::shared_ptr<RipsDS::Graph>(new RipsDS::Graph(distances_, max, 0));
+
+            KDTree tree(array.coordinates(), array.size(), array.dimension());
+            return boost::shared_ptr<RipsDS::Graph>(new RipsDS::Graph(distances_, tree, max, 0));
+        }
+
         DistancesWrapper                            distances_;
         RipsDS                                      rips_;
         ThreeOutcomeCompare<Comparison>             cmp_;           // in Python, cmp is a three outcome comparison
@@ -0,0 +1,110 @@
+#define BOOST_PYTHON_STATIC_LIB
+#include <topology/simplex-key.h>
+
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+#include <boost/shared_ptr.hpp>
+namespace bp = boost::python;
+
+#include "simplex.h"                // defines SimplexVD
+#include "filtration.h"             // defines PythonFiltration
+namespace dp = dionysus::python;
+
+
+namespace dionysus {
+namespace python   {
+
+// Maps simplices (by their keys, see SimplexKeys) to arbitrary Python objects
+class PythonSimplexKeyMap
+{
+    public:
+        typedef         SimplexKeys::Key                                    Key;
+
+                        PythonSimplexKeyMap(size_t vertices, Dimension max_dim):
+                            keys_(vertices, max_dim), map_(max_dim)         {}
+
+        void            add(const SimplexVD& s, bp::object value)           { check(s); map_.insert(s.dimension(), key(s), value); }
+        bp::object      getitem(const SimplexVD& s) const                   { check(s); return value(s.dimension(), key(s)); }
+        bool            contains(const SimplexVD& s) const                  { return s.dimension() <= map_.max_dimension() && in_range(s) && map_.find(s.dimension(), key(s)); }
+        void            erase(const SimplexVD& s)                           { check(s); map_.erase(s.dimension(), key(s)); }
+        size_t          size() const                                        { return map_.size(); }
+
+        // Values of the facets of s, in the order of s.boundary (every facet must be in the map)
+        bp::list        boundary(const SimplexVD& s) const
+        {
+            check(s);
+            bp::list result;
+            if (s.dimension() == 0) return result;
+            facets_.resize(s.dimension() + 1);
+            keys_.boundary(s.vertices().begin(), s.vertices().end(), facets_.begin());
+            for (size_t i = 0; i < facets_.size(); ++i)
+                result.append(value(s.dimension() - 1, facets_[i]));
+            return result;
+        }
+
+        // Maps every simplex of the filtration (of dimension at most the map's) to its position
+        void            index(const PythonFiltration& f)
+        {
+            unsigned i = 0;
+            for (PythonFiltration::Index cur = f.begin(); cur != f.end(); ++cur, ++i)
+                if (cur->dimension() <= map_.max_dimension())
+                    add(*cur, bp::object(i));
+        }
+
+    private:
+        bp::object      value(Dimension d, Key k) const
+        {
+            const bp::object* v = map_.find(d, k);
+            if (!v)
+            {
+                PyErr_SetString(PyExc_KeyError, "simplex is not in the map");
+                bp::throw_error_already_set();
+            }
+            return *v;
+        }
+
+        Key             key(const SimplexVD& s) const                       { return keys_.key(s.vertices().begin(), s.vertices().end()); }
+        bool            in_range(const SimplexVD& s) const                  { return s.vertices().front() >= 0 && static_cast<size_t>(s.vertices().back()) < keys_.vertices(); }
+        void            check(const SimplexVD& s) const
+        {
+            if (s.dimension() > map_.max_dimension() || !in_range(s))
+            {
+                PyErr_SetString(PyExc_ValueError, "simplex is outside the range of the map");
+                bp::throw_error_already_set();
+            }
+        }
+
+        SimplexKeys                 keys_;
+        SimplexKeyMap<bp::object>   map_;
+        mutable std::vector<Key>    facets_;
+};
+
+} } // namespace dionysus::python
+
+
+boost::shared_ptr<dp::PythonSimplexKeyMap>      init_with_dimension(size_t vertices, Dimension max_dim)
+{
+    if (!SimplexKeys::fits(vertices, max_dim))
+    {
+        PyErr_SetString(PyExc_OverflowError, "keys of the simplices do not fit into 64 bits");
+        bp::throw_error_already_set();
+    }
+    boost::shared_ptr<dp::PythonSimplexKeyMap>  p(new dp::PythonSimplexKeyMap(vertices, max_dim));
+    return p;
+}
+
+void export_simplex_key_map()
+{
+    bp::class_<dp::PythonSimplexKeyMap>("SimplexKeyMap", bp::no_init)
+        .def("__init__",        bp::make_constructor(&init_with_dimension))
+
+        .def("add",             &dp::PythonSimplexKeyMap::add)
+        .def("__setitem__",     &dp::PythonSimplexKeyMap::add)
+        .def("__getitem__",     &dp::PythonSimplexKeyMap::getitem)
+        .def("__contains__",    &dp::PythonSimplexKeyMap::contains)
+        .def("__delitem__",     &dp::PythonSimplexKeyMap::erase)
+        .def("__len__",         &dp::PythonSimplexKeyMap::size)
+        .def("boundary",        &dp::PythonSimplexKeyMap::boundary)
+        .def("index",           &dp::PythonSimplexKeyMap::index)
+    ;
+}
@@ -2,7 +2,10 @@
 #ifndef __PYTHON_UTILS_H__
 #define __PYTHON_UTILS_H__
 
+#include <topology/field-arithmetic.h>
+
 #include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/iterator/counting_iterator.hpp>
 namespace bp = boost::python;
 
@@ -52,6 +55,72 @@ struct PythonCmp
     bp::object      cmp_;
 };
 
+// Releases the GIL for the lifetime of the object; nothing may touch Python objects in the meantime
+class ScopedGILRelease
+{
+    public:
+                        ScopedGILRelease(): state_(PyEval_SaveThread())         {}
+                        ~ScopedGILRelease()                                     { PyEval_RestoreThread(state_); }
+
+    private:
+        PyThreadState*  state_;
+};
+
+// Acquires the GIL for the lifetime of the object, on any thread (e.g., a worker of parallel_for())
+class ScopedGILAcquire
+{
+    public:
+                        ScopedGILAcquire(): state_(PyGILState_Ensure())         {}
+                        ~ScopedGILAcquire()                                     { PyGILState_Release(state_); }
+
+    private:
+        PyGILState_STATE    state_;
+};
+
+// The current Python error, taken off the thread that raised it, so that it can travel as a C++ exception to another
+// thread (the one that called parallel_for() rethrows it) and be raised there with restore() and bp::throw_error_already_set()
+class PythonError
+{
+    public:
+        // The GIL must be held
+                        PythonError(): error_(new Error)                        { PyErr_Fetch(&error_->type, &error_->value, &error_->traceback); }
+
+        // Sets the error as the current one of the calling thread (once; the GIL must be held)
+        void            restore() const
+        {
+            PyErr_Restore(error_->type, error_->value, error_->traceback);
+            error_->type = error_->value = error_->traceback = 0;
+        }
+
+    private:
+        struct Error
+        {
+                        Error(): type(0), value(0), traceback(0)                {}
+                        ~Error()
+            {
+                ScopedGILAcquire gil;
+                Py_XDECREF(type); Py_XDECREF(value); Py_XDECREF(traceback);
+            }
+
+            PyObject    *type, *value, *traceback;
+        };
+
+        boost::shared_ptr<Error>    error_;
+};
+
+// Raises ValueError unless p is a prime below ZpField::prime_limit
+inline void         check_prime(unsigned p)
+{
+    bool prime = p >= 2 && p < static_cast<unsigned>(ZpField::prime_limit);
+    for (unsigned d = 2; prime && d*d <= p; ++d)
+        prime = p % d != 0;
+    if (!prime)
+    {
+        PyErr_SetString(PyExc_ValueError, "the field needs a prime p < 2^16");
+        bp::throw_error_already_set();
+    }
+}
+
 template<class T1, class T2>
 struct PairToTupleConverter 
 {
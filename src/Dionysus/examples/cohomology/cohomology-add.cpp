@@ -0,0 +1,160 @@
+#include <topology/cohomology-persistence.h>
+#include <topology/streamed-rips.h>
+
+#include <geometry/l2distance.h>
+#include <geometry/distances.h>
+
+#include <utilities/timer.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/tuple/tuple.hpp>
+#include <boost/program_options.hpp>
+
+// Times CohomologyPersistence::add() alone on the filtration of the Rips complex: the simplices and the positions
+// of their facets are generated up front (see StreamedRipsFiltration), so nothing but the persistence is measured
+
+typedef     PairwiseDistances<PointContainer, L2Distance>           PairDistances;
+typedef     PairDistances::DistanceType                             DistanceType;
+
+typedef     StreamedRipsFiltration<PairDistances>                   Filtration;
+typedef     Filtration::View                                        View;
+typedef     Filtration::Key                                         Key;
+
+typedef     boost::tuple<Dimension, DistanceType>                   BirthInfo;
+
+// The filtration with the boundary of every simplex as the positions of its facets
+struct      Simplices
+{
+    std::vector<BirthInfo>      births;
+    std::vector<unsigned>       offsets;                            // boundary of i is facets[offsets[i], offsets[i+1])
+    std::vector<unsigned>       facets;
+};
+
+struct      RecordSimplex
+{
+                RecordSimplex(const Filtration& filtration, Simplices& simplices, SimplexKeyMap<unsigned>& positions):
+                    filtration_(filtration), simplices_(simplices), positions_(positions),
+                    keys_(filtration.skeleton() + 1)                                            {}
+
+    void        operator()(const View& v, DistanceType value) const
+    {
+        Dimension d = v.dimension();
+        if (d > 0)
+        {
+            filtration_.facets(v.begin(), v.end(), keys_.begin());
+            for (Dimension i = 0; i <= d; ++i)
+                simplices_.facets.push_back(positions_(d - 1, keys_[i]));
+        }
+        simplices_.offsets.push_back(simplices_.facets.size());
+        if (d < filtration_.skeleton())
+            positions_.insert(d, filtration_.key(v.begin(), v.end()), simplices_.births.size());
+        simplices_.births.push_back(BirthInfo(d, value));
+    }
+
+    const Filtration&           filtration_;
+    Simplices&                  simplices_;
+    SimplexKeyMap<unsigned>&    positions_;
+    mutable std::vector<Key>    keys_;
+};
+
+template<class Storage>
+void        add_all(const Simplices& simplices, Dimension skeleton, ZpField::Element prime);
+
+void        program_options(int argc, char* argv[], std::string& infilename, Dimension& skeleton, DistanceType& max_distance, ZpField::Element& prime, bool& pooled);
+
+int main(int argc, char* argv[])
+{
+    Dimension               skeleton;
+    DistanceType            max_distance;
+    ZpField::Element        prime;
+    std::string             infilename;
+    bool                    pooled;
+
+    program_options(argc, argv, infilename, skeleton, max_distance, prime, pooled);
+
+    PointContainer          points;
+    read_points(infilename, points);
+
+    PairDistances           distances(points);
+    Filtration              filtration(distances, skeleton, max_distance);
+
+    Simplices               simplices;
+    simplices.offsets.push_back(0);
+    SimplexKeyMap<unsigned> positions(skeleton);
+    filtration.generate(RecordSimplex(filtration, simplices, positions));
+    std::cout << "# Simplices: " << simplices.births.size() << std::endl;
+
+    if (pooled)
+        add_all<PooledStorage>(simplices, skeleton, prime);
+    else
+        add_all<ListStorage>(simplices, skeleton, prime);
+}
+
+template<class Storage>
+void        add_all(const Simplices& simplices, Dimension skeleton, ZpField::Element prime)
+{
+    typedef     CohomologyPersistence<BirthInfo, Empty<>, ZpField, Storage>     Persistence;
+    typedef     typename Persistence::SimplexIndex                              Index;
+
+    Persistence             persistence((ZpField(prime)));
+    std::vector<Index>      indices(simplices.births.size());
+    std::vector<Index>      boundary;
+    size_t                  deaths = 0;
+
+    Timer add_timer; add_timer.start();
+    for (size_t i = 0; i < simplices.births.size(); ++i)
+    {
+        boundary.clear();
+        for (unsigned j = simplices.offsets[i]; j != simplices.offsets[i + 1]; ++j)
+            boundary.push_back(indices[simplices.facets[j]]);
+
+        Dimension               d = simplices.births[i].template get<0>();
+        typename Persistence::Death         death;
+        typename Persistence::CocyclePtr    cocycle;
+        boost::tie(indices[i], death, cocycle) = persistence.add(boundary.begin(), boundary.end(), simplices.births[i], d < skeleton);
+        if (death)
+            ++deaths;
+    }
+    add_timer.stop();
+
+    std::cout << "# Deaths: " << deaths << std::endl;
+    add_timer.check("# CohomologyPersistence::add()");
+}
+
+void        program_options(int argc, char* argv[], std::string& infilename, Dimension& skeleton, DistanceType& max_distance, ZpField::Element& prime, bool& pooled)
+{
+    namespace po = boost::program_options;
+
+    po::options_description     hidden("Hidden options");
+    hidden.add_options()
+        ("input-file",          po::value<std::string>(&infilename),        "Point set whose Rips complex we want to compute");
+
+    po::options_description visible("Allowed options", 100);
+    visible.add_options()
+        ("help,h",                                                                                  "produce help message")
+        ("skeleton-dimension,s",po::value<Dimension>(&skeleton)->default_value(2),                  "Dimension of the Rips complex we want to compute")
+        ("prime,p",             po::value<ZpField::Element>(&prime)->default_value(11),             "Prime p for the field F_p")
+        ("max-distance,m",      po::value<DistanceType>(&max_distance)->default_value(Infinity),    "Maximum value for the Rips complex construction")
+        ("pooled",                                                                                  "Use PooledStorage (instead of ListStorage)");
+
+    po::positional_options_description pos;
+    pos.add("input-file", 1);
+
+    po::options_description all; all.add(visible).add(hidden);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).
+                  options(all).positional(pos).run(), vm);
+    po::notify(vm);
+
+    pooled = vm.count("pooled");
+
+    if (vm.count("help") || !vm.count("input-file"))
+    {
+        std::cout << "Usage: " << argv[0] << " [options] input-file" << std::endl;
+        std::cout << visible << std::endl;
+        std::abort();
+    }
+}
@@ -1,5 +1,6 @@
 #include <topology/cohomology-persistence.h>
 #include <topology/rips.h>
+#include <topology/simplex-key.h>
 
 #include <geometry/l2distance.h>
 #include <geometry/distances.h>
@@ -34,7 +35,7 @@ typedef     Generator::Simplex                                      Smplx;
 typedef     std::vector<Smplx>                                      SimplexVector;
 typedef     SimplexVector::const_iterator                           SV_const_iterator;
 
-typedef     std::map<Smplx, Index, Smplx::VertexComparison>         Complex;
+typedef     SimplexKeyMap<Index>                                    Complex;
 
 #include "output.h"         // for output_*()
 
@@ -81,7 +82,10 @@ int main(int argc, char* argv[])
         index_in_v[idx] = idx;
     std::sort(index_in_v.begin(), index_in_v.end(), IndirectIndexComparison<SimplexVector, Generator::Comparison>(v, cmp));
 
-    BinarySearchMap<Smplx, SimplexVector::iterator, Smplx::VertexComparison> map_of_v(v.begin(), v.end());
+    // faces are looked up by their keys
+    SimplexKeys             keys(points.size(), skeleton);
+    Complex                 complex(skeleton);
+    std::vector<SimplexKeys::Key>   facets(skeleton + 1);
 
     rips_timer.stop();
     std::cout << "Simplex vector generated, size: " << v.size() << std::endl;
@@ -110,16 +114,19 @@ int main(int argc, char* argv[])
     {
         SimplexVector::const_iterator cur = v.begin() + index_in_v[j];
         std::vector<Index>      boundary;
-        for (Smplx::BoundaryIterator bcur  = cur->boundary_begin(); bcur != cur->boundary_end(); ++bcur)
-            boundary.push_back(map_of_v[*bcur]->data());
+        if (cur->dimension() > 0)
+        {
+            keys.boundary(cur->vertices().begin(), cur->vertices().end(), facets.begin());
+            for (Dimension i = 0; i <= cur->dimension(); ++i)
+                boundary.push_back(complex(cur->dimension() - 1, facets[i]));
+        }
         
         Index idx; Death d; CocyclePtr ccl;
         bool store = cur->dimension() < skeleton;
         boost::tie(idx, d, ccl)     = p.add(boundary.begin(), boundary.end(), boost::make_tuple(cur->dimension(), size(*cur)), store, index_in_v[j]);
         
-        // c[*cur] = idx;
         if (store)
-            map_of_v[*cur]->data() = idx;
+            complex.insert(cur->dimension(), keys.key(cur->vertices().begin(), cur->vertices().end()), idx);
 
         if (d && (size(*cur) - d->get<1>()) > 0)
         {
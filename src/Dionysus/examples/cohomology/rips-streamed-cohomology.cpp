@@ -0,0 +1,129 @@
+#include <topology/rips-cohomology.h>
+
+#include <geometry/l2distance.h>
+#include <geometry/distances.h>
+
+#include <utilities/timer.h>
+#include <utilities/log.h>
+
+#include <string>
+#include <fstream>
+
+#include <boost/program_options.hpp>
+
+// Same diagram as rips-pairwise-cohomology, but computed without storing the top-dimensional simplices
+// (see RipsCohomology)
+
+typedef     PairwiseDistances<PointContainer, L2Distance>           PairDistances;
+typedef     PairDistances::DistanceType                             DistanceType;
+
+typedef     RipsCohomology<PairDistances>                           Cohomology;
+typedef     Cohomology::Filtration                                  Filtration;
+
+// Outputs the pairs of non-zero persistence
+struct      OutputPair
+{
+                OutputPair(std::ostream& out): out_(out)            {}
+
+    void        operator()(Dimension d, DistanceType birth, DistanceType death, const Cohomology::ZColumn&) const
+    { 
+        if (death > birth) 
+            out_ << d << " " << birth << " " << death << std::endl; 
+    }
+
+    std::ostream&   out_;
+};
+
+void        program_options(int argc, char* argv[], std::string& infilename, Dimension& skeleton, DistanceType& max_distance, ZpField::Element& prime, std::string& diagram_name, bool& apparent_pairs);
+
+int main(int argc, char* argv[])
+{
+#ifdef LOGGING
+    rlog::RLogInit(argc, argv);
+
+    stderrLog.subscribeTo( RLOG_CHANNEL("error") );
+#endif
+
+    Dimension               skeleton;
+    DistanceType            max_distance;
+    ZpField::Element        prime;
+    std::string             infilename, diagram_name;
+    bool                    apparent_pairs;
+
+    program_options(argc, argv, infilename, skeleton, max_distance, prime, diagram_name, apparent_pairs);
+    std::ofstream           diagram_out(diagram_name.c_str());
+    std::cout << "Diagram:         " << diagram_name << std::endl;
+
+    Timer total_timer; total_timer.start();
+    PointContainer          points;
+    read_points(infilename, points);
+
+    PairDistances           distances(points);
+
+    Timer graph_timer; graph_timer.start();
+    Filtration              filtration(distances, skeleton, max_distance);
+    graph_timer.stop();
+    std::cout << "Edges: " << filtration.graph().edges() << std::endl;
+
+    Timer persistence_timer; persistence_timer.start();
+    ZpField                 zp(prime);
+    Cohomology              cohomology(filtration, zp, apparent_pairs);
+    cohomology.compute(OutputPair(diagram_out));
+
+    // output infinte persistence pairs 
+    for (Cohomology::CocycleIndex cur = cohomology.begin(); cur != cohomology.end(); ++cur)
+        diagram_out << cur->birth.get<0>() << " " << cur->birth.get<1>() << " inf" << std::endl;
+    persistence_timer.stop();
+    total_timer.stop();
+
+    graph_timer.check("Graph timer");
+    persistence_timer.check("Persistence timer");
+    total_timer.check("Total timer");
+}
+
+void        program_options(int argc, char* argv[], std::string& infilename, Dimension& skeleton, DistanceType& max_distance, ZpField::Element& prime, std::string& diagram_name, bool& apparent_pairs)
+{
+    namespace po = boost::program_options;
+
+    po::options_description     hidden("Hidden options");
+    hidden.add_options()
+        ("input-file",          po::value<std::string>(&infilename),        "Point set whose Rips complex we want to compute");
+    
+    po::options_description visible("Allowed options", 100);
+    visible.add_options()
+        ("help,h",                                                                                  "produce help message")
+        ("skeleton-dimension,s",po::value<Dimension>(&skeleton)->default_value(2),                  "Dimension of the Rips complex we want to compute")
+        ("prime,p",             po::value<ZpField::Element>(&prime)->default_value(11),             "Prime p for the field F_p")
+        ("max-distance,m",      po::value<DistanceType>(&max_distance)->default_value(Infinity),    "Maximum value for the Rips complex construction")
+        ("diagram,d",           po::value<std::string>(&diagram_name),                              "Filename where to output the persistence diagram")
+        ("no-apparent-pairs",                                                                       "Add every simplex with the full search (no apparent pairs or clearing)");
+#if LOGGING
+    std::vector<std::string>    log_channels;
+    visible.add_options()
+        ("log,l",               po::value< std::vector<std::string> >(&log_channels),           "log channels to turn on (info, debug, etc)");
+#endif
+
+    po::positional_options_description pos;
+    pos.add("input-file", 1);
+    
+    po::options_description all; all.add(visible).add(hidden);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).
+                  options(all).positional(pos).run(), vm);
+    po::notify(vm);
+
+#if LOGGING
+    for (std::vector<std::string>::const_iterator cur = log_channels.begin(); cur != log_channels.end(); ++cur)
+        stderrLog.subscribeTo( RLOG_CHANNEL(cur->c_str()) );
+#endif
+
+    apparent_pairs = !vm.count("no-apparent-pairs");
+
+    if (vm.count("help") || !vm.count("input-file"))
+    { 
+        std::cout << "Usage: " << argv[0] << " [options] input-file" << std::endl;
+        std::cout << visible << std::endl; 
+        std::abort();
+    }
+}
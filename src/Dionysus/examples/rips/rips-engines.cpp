@@ -0,0 +1,146 @@
+#include <topology/rips.h>
+
+#include <geometry/l2distance.h>
+#include <geometry/distances.h>
+
+#include <utilities/containers.h>
+#include <utilities/timer.h>
+
+#include <boost/program_options.hpp>
+
+
+// Compares the running times of the different ways of generating the Rips complex:
+// Bron-Kerbosch with the distances evaluated on the fly (reporting simplices or views),
+// the clique expansion of the precomputed neighbor graph with each of the engines
+// (see rips-engines.h), and the edge sweep that reports the simplices in the filtration order
+// (see edge-sweep.h)
+
+typedef         PairwiseDistances<PointContainer, L2Distance>           PairDistances;
+typedef         PairDistances::DistanceType                             DistanceType;
+typedef         PairDistances::IndexType                                Vertex;
+
+typedef         Rips<PairDistances>                                     ListGenerator;
+typedef         Rips<PairDistances, ListGenerator::Simplex, BitsetEngine>
+                                                                        BitsetGenerator;
+typedef         ListGenerator::Graph                                    Graph;
+typedef         ListGenerator::Simplex                                  Smplx;
+
+// Counts the simplices (and their vertices, so that the compiler cannot drop the work);
+// works with both Smplx and ListGenerator::View, with or without the value
+struct CountFunctor
+{
+                CountFunctor(size_t& simplices, size_t& vertices):
+                    simplices_(simplices), vertices_(vertices)      {}
+
+    template<class S>
+    void        operator()(const S& s) const                        { ++simplices_; vertices_ += s.dimension() + 1; }
+
+    template<class S>
+    void        operator()(const S& s, DistanceType) const          { (*this)(s); }
+
+    size_t&     simplices_;
+    size_t&     vertices_;
+};
+
+void            program_options(int argc, char* argv[], std::string& infilename, Dimension& skeleton, DistanceType& max_distance);
+
+int main(int argc, char* argv[])
+{
+    Dimension               skeleton;
+    DistanceType            max_distance;
+    std::string             infilename;
+
+    program_options(argc, argv, infilename, skeleton, max_distance);
+
+    PointContainer          points;
+    read_points(infilename, points);
+
+    PairDistances           distances(points);
+    ListGenerator           list_rips(distances);
+    BitsetGenerator         bitset_rips(distances);
+
+    size_t simplices = 0, vertices = 0;
+
+    Timer distances_timer; distances_timer.start();
+    list_rips.generate(skeleton, max_distance, CountFunctor(simplices, vertices));
+    distances_timer.stop();
+    std::cout << "# Simplices: " << simplices << ", vertices: " << vertices << std::endl;
+    distances_timer.check("# Bron-Kerbosch (distances)");
+
+    simplices = vertices = 0;
+    Timer views_timer; views_timer.start();
+    list_rips.generate_views(skeleton, max_distance, CountFunctor(simplices, vertices));
+    views_timer.stop();
+    std::cout << "# Simplices: " << simplices << ", vertices: " << vertices << std::endl;
+    views_timer.check("# Bron-Kerbosch (distances, views)");
+
+    Timer graph_timer; graph_timer.start();
+    Graph                   graph(distances, max_distance);
+    graph_timer.stop();
+    std::cout << "# Edges: " << graph.edges() << std::endl;
+    graph_timer.check("# Neighbor graph");
+
+    simplices = vertices = 0;
+    Timer list_timer; list_timer.start();
+    list_rips.generate_views(skeleton, graph, CountFunctor(simplices, vertices));
+    list_timer.stop();
+    std::cout << "# Simplices: " << simplices << ", vertices: " << vertices << std::endl;
+    list_timer.check("# Sorted list engine");
+
+    simplices = vertices = 0;
+    Timer bitset_timer; bitset_timer.start();
+    bitset_rips.generate_views(skeleton, graph, CountFunctor(simplices, vertices));
+    bitset_timer.stop();
+    std::cout << "# Simplices: " << simplices << ", vertices: " << vertices << std::endl;
+#ifdef __AVX2__
+    bitset_timer.check("# Bitset engine (AVX2)");
+#else
+    bitset_timer.check("# Bitset engine");
+#endif
+
+    simplices = vertices = 0;
+    Timer sorted_timer; sorted_timer.start();
+    list_rips.generate_sorted(skeleton, graph, CountFunctor(simplices, vertices));
+    sorted_timer.stop();
+    std::cout << "# Simplices: " << simplices << ", vertices: " << vertices << std::endl;
+    sorted_timer.check("# Edge sweep (filtration order)");
+
+    std::vector<Smplx>      filtration;
+    Timer sort_timer; sort_timer.start();
+    list_rips.generate(skeleton, graph, make_push_back_functor(filtration));
+    std::sort(filtration.begin(), filtration.end(), ListGenerator::Comparison(distances));
+    sort_timer.stop();
+    sort_timer.check("# Sorted list engine + sort (for comparison)");
+}
+
+void        program_options(int argc, char* argv[], std::string& infilename, Dimension& skeleton, DistanceType& max_distance)
+{
+    namespace po = boost::program_options;
+
+    po::options_description     hidden("Hidden options");
+    hidden.add_options()
+        ("input-file",          po::value<std::string>(&infilename),        "Point set whose Rips complex we want to generate");
+
+    po::options_description visible("Allowed options", 100);
+    visible.add_options()
+        ("help,h",                                                                                  "produce help message")
+        ("skeleton-dimension,s",po::value<Dimension>(&skeleton)->default_value(2),                  "Dimension of the Rips complex we want to compute")
+        ("max-distance,m",      po::value<DistanceType>(&max_distance)->default_value(Infinity),    "Maximum value for the Rips complex construction");
+
+    po::positional_options_description pos;
+    pos.add("input-file", 1);
+
+    po::options_description all; all.add(visible).add(hidden);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).
+                  options(all).positional(pos).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help") || !vm.count("input-file"))
+    {
+        std::cout << "Usage: " << argv[0] << " [options] input-file" << std::endl;
+        std::cout << visible << std::endl;
+        std::abort();
+    }
+}
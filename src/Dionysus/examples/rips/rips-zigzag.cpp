@@ -1,5 +1,6 @@
 #include <topology/rips.h>
 #include <topology/zigzag-persistence.h>
+#include <topology/simplex-key.h>
 #include <utilities/types.h>
 #include <utilities/containers.h>
 
@@ -45,8 +46,7 @@ struct      BirthInfo;
 typedef     ZigzagPersistence<BirthInfo>                            Zigzag;
 typedef     Zigzag::SimplexIndex                                    Index;
 typedef     Zigzag::Death                                           Death;
-typedef     std::map<Smplx, Index, 
-                            Smplx::VertexDimensionComparison>       Complex;
+typedef     SimplexKeyMap<Index>                                    Complex;
 typedef     Zigzag::ZColumn                                         Boundary;
 
 // Information we need to know when a class dies
@@ -60,7 +60,9 @@ struct      BirthInfo
 
 // Forward declarations of auxilliary functions
 void        report_death(std::ostream& out, Death d, DistanceType epsilon, Dimension skeleton_dimension);
-void        make_boundary(const Smplx& s, Complex& c, const Zigzag& zz, Boundary& b);
+SimplexKeys::Key
+            key(const Smplx& s, const SimplexKeys& keys)            { return keys.key(s.vertices().begin(), s.vertices().end()); }
+void        make_boundary(const Smplx& s, const SimplexKeys& keys, Complex& c, const Zigzag& zz, Boundary& b);
 std::ostream&   operator<<(std::ostream& out, const BirthInfo& bi);
 void        process_command_line_options(int           argc,
                                          char*         argv[],
@@ -140,7 +142,8 @@ int main(int argc, char* argv[])
         rDebug("  (%d, %d) %f", cur->first, cur->second, distances(cur->first, cur->second));
 
     // Construct zigzag
-    Complex             complex;
+    SimplexKeys         keys(points.size(), skeleton_dimension);
+    Complex             complex(skeleton_dimension);
     Zigzag              zz;
     RipsGenerator       rips(distances);
     SimplexEvaluator    size(distances);
@@ -152,9 +155,9 @@ int main(int argc, char* argv[])
         Smplx sv; sv.add(vertices[i]);
         rDebug("Adding %s", tostring(sv).c_str());
         add.start();
-        complex.insert(std::make_pair(sv, 
-                                      zz.add(Boundary(), 
-                                             BirthInfo(0, 0)).first));
+        complex.insert(0, key(sv, keys),
+                       zz.add(Boundary(), 
+                              BirthInfo(0, 0)).first);
         add.stop();
         //rDebug("Newly born cycle order: %d", complex[sv]->low->order);
         CountNum(cComplexSize, 0);
@@ -204,7 +207,7 @@ int main(int argc, char* argv[])
         {
             Index idx; Death d; Boundary b;
             rDebug("  Adding %s, its size %f", tostring(*cur).c_str(), size(*cur));
-            make_boundary(*cur, complex, zz, b);
+            make_boundary(*cur, keys, complex, zz, b);
             add.start();
             boost::tie(idx, d)  = zz.add(b,
                                          BirthInfo(epsilons[i-1], cur->dimension()));
@@ -214,7 +217,7 @@ int main(int argc, char* argv[])
             Count(cComplexSize);
             Count(cOperations);
             AssertMsg(zz.check_consistency(), "Zigzag representation must be consistent after removing a simplex");
-            complex.insert(std::make_pair(*cur, idx));
+            complex.insert(cur->dimension(), key(*cur, keys), idx);
             report_death(out, d, epsilons[i-1], skeleton_dimension);
         }
         rInfo("Increased epsilon; complex size: %d", complex.size());
@@ -235,12 +238,12 @@ int main(int argc, char* argv[])
         for (SimplexSet::const_reverse_iterator cur = cofaces.rbegin(); cur != (SimplexSet::const_reverse_iterator)cofaces.rend(); ++cur)
         {
             rDebug("    Removing: %s", tostring(*cur).c_str());
-            Complex::iterator si = complex.find(*cur);
+            SimplexKeys::Key k = key(*cur, keys);
             remove.start();
-            Death d = zz.remove(si->second,
+            Death d = zz.remove(complex(cur->dimension(), k),
                                 BirthInfo(epsilons[i-1], cur->dimension() - 1));
             remove.stop();
-            complex.erase(si);
+            complex.erase(cur->dimension(), k);
             CountNumBy(cComplexSize, cur->dimension(), -1);
             CountBy(cComplexSize, -1);
             Count(cOperations);
@@ -248,8 +251,6 @@ int main(int argc, char* argv[])
             report_death(out, d, epsilons[i-1], skeleton_dimension);
         }
         rInfo("Removed vertex; complex size: %d", complex.size());
-        for (Complex::const_iterator cur = complex.begin(); cur != complex.end(); ++cur)
-            rDebug("  %s", tostring(cur->first).c_str());
         report_memory();
         
         ++show_progress;
@@ -257,10 +258,11 @@ int main(int argc, char* argv[])
     
     // Remove the last vertex
     AssertMsg(complex.size() == 1, "Only one vertex must remain");
+    SimplexKeys::Key last = keys.key(vertices.begin(), vertices.begin() + 1);
     remove.start();
-    Death d = zz.remove(complex.begin()->second, BirthInfo(epsilons[0], -1));
+    Death d = zz.remove(complex(0, last), BirthInfo(epsilons[0], -1));
     remove.stop();
-    complex.erase(complex.begin());
+    complex.erase(0, last);
     if (!d)  AssertMsg(false,  "The vertex must have died");
     report_death(out, d, epsilons[0], skeleton_dimension);
     CountNumBy(cComplexSize, 0, -1);
@@ -286,13 +288,18 @@ void        report_death(std::ostream& out, Death d, DistanceType epsilon, Dimen
         out << d->dimension << " " << d->distance << " " << epsilon << std::endl;
 }
 
-void        make_boundary(const Smplx& s, Complex& c, const Zigzag& zz, Boundary& b)
+void        make_boundary(const Smplx& s, const SimplexKeys& keys, Complex& c, const Zigzag& zz, Boundary& b)
 {
     rDebug("  Boundary of <%s>", tostring(s).c_str());
-    for (Smplx::BoundaryIterator cur = s.boundary_begin(); cur != s.boundary_end(); ++cur)
+    if (s.dimension() == 0)
+        return;
+
+    std::vector<SimplexKeys::Key> facets(s.dimension() + 1);
+    keys.boundary(s.vertices().begin(), s.vertices().end(), facets.begin());
+    for (size_t i = 0; i < facets.size(); ++i)
     {
-        b.append(c[*cur], zz.cmp);
-        rDebug("   %d", c[*cur]->order);
+        b.append(c(s.dimension() - 1, facets[i]), zz.cmp);
+        rDebug("   %d", c(s.dimension() - 1, facets[i])->order);
     }
 }
 
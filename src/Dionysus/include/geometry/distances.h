@@ -18,7 +18,7 @@ class ExplicitDistances
 
                             ExplicitDistances(IndexType size):
                                 size_(size), 
-                                distances_(size*(size + 1)/2 + size)        {}
+                                distances_(size*(size + 1)/2)               {}
                             ExplicitDistances(const Distances& distances);
 
         DistanceType        operator()(IndexType a, IndexType b) const;
@@ -33,6 +33,11 @@ class ExplicitDistances
         size_t                                      size_;
 };
 
+// Fills out with the distances d(a,b), a <= b, in the order of ExplicitDistances, one pair at a time; overloaded for the
+// distances that are faster to compute all at once (see l2distance.h)
+template<class Distances>
+void                fill_explicit_distances(const Distances& distances, std::vector<typename Distances::DistanceType>& out);
+
 
 /**
  * Class: PairwiseDistances
@@ -61,6 +66,8 @@ class PairwiseDistances
         IndexType           begin() const                                   { return 0; }
         IndexType           end() const                                     { return size(); }
 
+        const Container&    container() const                               { return container_; }
+
     private:
         const Container&    container_;
         Distance            distance_;
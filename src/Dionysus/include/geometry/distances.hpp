@@ -3,11 +3,18 @@ ExplicitDistances<Distances_>::
 ExplicitDistances(const Distances& distances): 
     size_(distances.size()), distances_((distances.size() * (distances.size() + 1))/2)
 {
-    IndexType i = 0;
+    fill_explicit_distances(distances, distances_);
+}
+
+template<class Distances>
+void
+fill_explicit_distances(const Distances& distances, std::vector<typename Distances::DistanceType>& out)
+{
+    size_t i = 0;
     for (typename Distances::IndexType a = distances.begin(); a != distances.end(); ++a)
         for (typename Distances::IndexType b = a; b != distances.end(); ++b)
         {
-            distances_[i++] = distances(a,b);
+            out[i++] = distances(a,b);
         }
 }
 
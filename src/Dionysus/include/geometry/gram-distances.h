@@ -0,0 +1,83 @@
+#ifndef __GRAM_DISTANCES_H__
+#define __GRAM_DISTANCES_H__
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+
+/**
+ * Function: gram_distances(points, n, dimension, out, exact, threads)
+ * Computes the Euclidean distances between all the pairs of the n points (the rows of the n by dimension row-major
+ * array points), and calls out(i, j, distance) for every i < j (from several threads at once, each pair once).
+ *
+ * The squared distances come from the Gram matrix, |a - b|^2 = |a|^2 + |b|^2 - 2 a.b, one tile of rows against one tile
+ * of columns at a time: the tiles of the columns are transposed up front and sized to stay in L2, the rows are taken four
+ * at a time, and the inner loops run over the columns of a tile with AVX-512 or AVX2 (when compiled with them) or plain
+ * scalar code. The row tiles are distributed among the threads with parallel_for() (threads = 0 uses all the cores).
+ *
+ * The points are centered first, which leaves the distances as they are, but keeps |a|^2 + |b|^2 small. The cancellation
+ * loses about log10((|a|^2 + |b|^2) / |a - b|^2) of the 16 digits, so the few pairs whose squared distance is still below
+ * 1e-4 (|a|^2 + |b|^2), where it would lose 4 digits or more, are recomputed directly, and every distance keeps about 12.
+ * With exact, all the distances are computed directly, as the square roots of the sums of the squared differences of the
+ * points as they are, in the order of the coordinates, in the same blocked loops: the same operations as L2Distance.
+ */
+template<class Output>
+void                gram_distances(const double* points, size_t n, size_t dimension, Output& out,
+                                   bool exact = false, unsigned threads = 0);
+
+
+/**
+ * Class: GramDistances
+ * Stores the Euclidean distances between the points of a PointContainer-like container (of std::vector<double>, or the rows
+ * of a row-major array) as the condensed matrix of d(i,j) for i < j, all computed by gram_distances() at construction.
+ * A Distances template argument for Rips, like ExplicitDistances, with half of the memory.
+ */
+class GramDistances
+{
+    public:
+        typedef             unsigned                                        IndexType;
+        typedef             double                                          DistanceType;
+
+                            GramDistances(const double* points, size_t n, size_t dimension, bool exact = false, unsigned threads = 0)
+        { compute(points, n, dimension, exact, threads); }
+
+        template<class Container>
+                            GramDistances(const Container& points, bool exact = false, unsigned threads = 0);
+
+        DistanceType        operator()(IndexType a, IndexType b) const
+        {
+            if (a == b) return 0;
+            if (a > b) std::swap(a, b);
+            return distances_[index(a, b)];
+        }
+
+        size_t              size() const                                    { return size_; }
+        IndexType           begin() const                                   { return 0; }
+        IndexType           end() const                                     { return size(); }
+
+        // The condensed matrix, d(0,1), ..., d(0,n-1), d(1,2), ...
+        const std::vector<DistanceType>&
+                            condensed() const                               { return distances_; }
+
+        // Position of d(a,b), a < b, in condensed()
+        size_t              index(size_t a, size_t b) const                 { return a*size_ - a*(a+1)/2 + (b - a - 1); }
+
+        // out(i, j, distance) of gram_distances()
+        void                operator()(size_t a, size_t b, DistanceType d)  { distances_[index(a, b)] = d; }
+
+    private:
+        void                compute(const double* points, size_t n, size_t dimension, bool exact, unsigned threads)
+        {
+            size_ = n;
+            distances_.assign(n*(n - (n > 0))/2, 0);
+            gram_distances(points, n, dimension, *this, exact, threads);
+        }
+
+        size_t                                      size_;
+        std::vector<DistanceType>                   distances_;
+};
+
+#include "gram-distances.hpp"
+
+#endif // __GRAM_DISTANCES_H__
@@ -0,0 +1,246 @@
+#include <utilities/parallel.h>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Class: GramKernel
+ * Inner loops of gram_distances(). A panel is a tile of width (a multiple of 8) points transposed, so that the k-th
+ * coordinates of all of them, panel[k*width], ..., panel[k*width + width - 1], are contiguous. For four rows a[0], ..., a[3]
+ * (pointers to dimension coordinates each), the kernels write the width values for every row into out[r*width + j]:
+ * the dot products a[r].p_j, or the squared distances |a[r] - p_j|^2. Every 8 columns are accumulated in registers over
+ * all the coordinates.
+ */
+struct GramKernel
+{
+    static void     products(const double* const* a, const double* panel, size_t width, size_t dimension, double* out)
+    {
+        for (size_t j = 0; j < width; j += 8)
+        {
+#if defined(__AVX512F__)
+            __m512d s0 = _mm512_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+            for (size_t k = 0; k < dimension; ++k)
+            {
+                __m512d p = _mm512_loadu_pd(panel + k*width + j);
+                s0 = _mm512_fmadd_pd(_mm512_set1_pd(a[0][k]), p, s0);
+                s1 = _mm512_fmadd_pd(_mm512_set1_pd(a[1][k]), p, s1);
+                s2 = _mm512_fmadd_pd(_mm512_set1_pd(a[2][k]), p, s2);
+                s3 = _mm512_fmadd_pd(_mm512_set1_pd(a[3][k]), p, s3);
+            }
+            _mm512_storeu_pd(out + j, s0);             _mm512_storeu_pd(out + width + j, s1);
+            _mm512_storeu_pd(out + 2*width + j, s2);   _mm512_storeu_pd(out + 3*width + j, s3);
+#elif defined(__AVX2__)
+            __m256d s[8];
+            for (int r = 0; r < 8; ++r)
+                s[r] = _mm256_setzero_pd();
+            for (size_t k = 0; k < dimension; ++k)
+            {
+                __m256d p0 = _mm256_loadu_pd(panel + k*width + j), p1 = _mm256_loadu_pd(panel + k*width + j + 4);
+                for (int r = 0; r < 4; ++r)
+                {
+                    __m256d x = _mm256_set1_pd(a[r][k]);
+                    s[2*r]     = _mm256_add_pd(s[2*r],     _mm256_mul_pd(x, p0));
+                    s[2*r + 1] = _mm256_add_pd(s[2*r + 1], _mm256_mul_pd(x, p1));
+                }
+            }
+            for (int r = 0; r < 4; ++r)
+            {
+                _mm256_storeu_pd(out + r*width + j,     s[2*r]);
+                _mm256_storeu_pd(out + r*width + j + 4, s[2*r + 1]);
+            }
+#else
+            double s[4][8] = {};
+            for (size_t k = 0; k < dimension; ++k)
+            {
+                const double* p = panel + k*width + j;
+                for (int r = 0; r < 4; ++r)
+                    for (int c = 0; c < 8; ++c)
+                        s[r][c] += a[r][k]*p[c];
+            }
+            for (int r = 0; r < 4; ++r)
+                std::copy(s[r], s[r] + 8, out + r*width + j);
+#endif
+        }
+    }
+
+    static void     differences(const double* const* a, const double* panel, size_t width, size_t dimension, double* out)
+    {
+        for (size_t j = 0; j < width; j += 8)
+        {
+#if defined(__AVX512F__)
+            __m512d s0 = _mm512_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+            for (size_t k = 0; k < dimension; ++k)
+            {
+                __m512d p = _mm512_loadu_pd(panel + k*width + j), d;
+                d = _mm512_sub_pd(_mm512_set1_pd(a[0][k]), p);   s0 = _mm512_add_pd(s0, _mm512_mul_pd(d, d));
+                d = _mm512_sub_pd(_mm512_set1_pd(a[1][k]), p);   s1 = _mm512_add_pd(s1, _mm512_mul_pd(d, d));
+                d = _mm512_sub_pd(_mm512_set1_pd(a[2][k]), p);   s2 = _mm512_add_pd(s2, _mm512_mul_pd(d, d));
+                d = _mm512_sub_pd(_mm512_set1_pd(a[3][k]), p);   s3 = _mm512_add_pd(s3, _mm512_mul_pd(d, d));
+            }
+            _mm512_storeu_pd(out + j, s0);             _mm512_storeu_pd(out + width + j, s1);
+            _mm512_storeu_pd(out + 2*width + j, s2);   _mm512_storeu_pd(out + 3*width + j, s3);
+#elif defined(__AVX2__)
+            __m256d s[8];
+            for (int r = 0; r < 8; ++r)
+                s[r] = _mm256_setzero_pd();
+            for (size_t k = 0; k < dimension; ++k)
+            {
+                __m256d p0 = _mm256_loadu_pd(panel + k*width + j), p1 = _mm256_loadu_pd(panel + k*width + j + 4);
+                for (int r = 0; r < 4; ++r)
+                {
+                    __m256d x  = _mm256_set1_pd(a[r][k]);
+                    __m256d d0 = _mm256_sub_pd(x, p0), d1 = _mm256_sub_pd(x, p1);
+                    s[2*r]     = _mm256_add_pd(s[2*r],     _mm256_mul_pd(d0, d0));
+                    s[2*r + 1] = _mm256_add_pd(s[2*r + 1], _mm256_mul_pd(d1, d1));
+                }
+            }
+            for (int r = 0; r < 4; ++r)
+            {
+                _mm256_storeu_pd(out + r*width + j,     s[2*r]);
+                _mm256_storeu_pd(out + r*width + j + 4, s[2*r + 1]);
+            }
+#else
+            double s[4][8] = {};
+            for (size_t k = 0; k < dimension; ++k)
+            {
+                const double* p = panel + k*width + j;
+                for (int r = 0; r < 4; ++r)
+                    for (int c = 0; c < 8; ++c)
+                        s[r][c] += (a[r][k] - p[c])*(a[r][k] - p[c]);
+            }
+            for (int r = 0; r < 4; ++r)
+                std::copy(s[r], s[r] + 8, out + r*width + j);
+#endif
+        }
+    }
+};
+
+// Computes the distances of the points of the row tile t against the points of the tiles t, t+1, ...; a task of parallel_for()
+template<class Output>
+class GramDistancesTask
+{
+    public:
+                            GramDistancesTask(const std::vector<double>& points, const std::vector<double>& norms,
+                                              const std::vector<double>& panels, size_t n, size_t dimension, size_t width,
+                                              bool exact, Output& out, unsigned threads):
+                                points_(points), norms_(norms), panels_(panels), n_(n), dimension_(dimension),
+                                width_(width), exact_(exact), out_(out), zero_(dimension, 0),
+                                buffers_(threads, std::vector<double>(4*width))       {}
+
+        void                operator()(size_t t, unsigned worker)
+        {
+            std::vector<double>&    values = buffers_[worker];
+            size_t                  end    = std::min(n_, (t + 1)*width_);
+            for (size_t c = t; c*width_ < n_; ++c)               // the panel of the tile c stays in the cache for all the rows
+            {
+                const double* panel = &panels_[c*width_*dimension_];
+                for (size_t i = t*width_; i < end; i += 4)
+                {
+                    const double* a[4];
+                    for (int r = 0; r < 4; ++r)
+                        a[r] = i + r < end ? &points_[(i + r)*dimension_] : &zero_[0];
+
+                    if (exact_)
+                        GramKernel::differences(a, panel, width_, dimension_, &values[0]);
+                    else
+                        GramKernel::products(a, panel, width_, dimension_, &values[0]);
+
+                    for (size_t r = 0; r < 4 && i + r < end; ++r)
+                        for (size_t j = std::max(c*width_, i + r + 1); j < std::min(n_, (c + 1)*width_); ++j)
+                            out_(i + r, j, distance(i + r, j, values[r*width_ + j - c*width_]));
+                }
+            }
+        }
+
+    private:
+        double              distance(size_t i, size_t j, double value) const
+        {
+            if (exact_)
+                return std::sqrt(value);
+
+            double scale = norms_[i] + norms_[j];
+            double d2    = scale - 2*value;
+            if (d2 < 1e-4*scale)                                // too much cancellation
+            {
+                const double* a = &points_[i*dimension_];
+                const double* b = &points_[j*dimension_];
+                d2 = 0;
+                for (size_t k = 0; k < dimension_; ++k)
+                    d2 += (a[k] - b[k])*(a[k] - b[k]);
+            }
+            return std::sqrt(d2);
+        }
+
+        const std::vector<double>&          points_;
+        const std::vector<double>&          norms_;
+        const std::vector<double>&          panels_;
+        size_t                              n_, dimension_, width_;
+        bool                                exact_;
+        Output&                             out_;
+        std::vector<double>                 zero_;
+        std::vector< std::vector<double> >  buffers_;           // the values of the four rows, one per worker
+};
+
+template<class Output>
+void
+gram_distances(const double* points, size_t n, size_t dimension, Output& out, bool exact, unsigned threads)
+{
+    if (n < 2)
+        return;
+    if (dimension == 0)
+    {
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = i + 1; j < n; ++j)
+                out(i, j, 0.);
+        return;
+    }
+
+    // the tile of the columns (width*dimension doubles) takes at most 128KB
+    size_t width = std::max<size_t>(8, std::min<size_t>(256, 16384/dimension) / 8 * 8);
+    width = std::min(width, (n + 7) / 8 * 8);
+    size_t tiles = (n + width - 1) / width;
+
+    // center the points (unless exact: the differences need no centering, and without it they are the same as L2Distance's)
+    std::vector<double> mean(dimension, 0), centered(n*dimension), norms(n, 0);
+    if (!exact)
+    {
+        for (size_t i = 0; i < n; ++i)
+            for (size_t k = 0; k < dimension; ++k)
+                mean[k] += points[i*dimension + k];
+        for (size_t k = 0; k < dimension; ++k)
+            mean[k] /= n;
+    }
+    for (size_t i = 0; i < n; ++i)
+        for (size_t k = 0; k < dimension; ++k)
+        {
+            double x = points[i*dimension + k] - mean[k];
+            centered[i*dimension + k] = x;
+            norms[i] += x*x;
+        }
+
+    // transpose the tiles of the columns (the points past the end stay at 0)
+    std::vector<double> panels(tiles*width*dimension, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        double* panel = &panels[(i / width)*width*dimension];
+        for (size_t k = 0; k < dimension; ++k)
+            panel[k*width + i % width] = centered[i*dimension + k];
+    }
+
+    threads = default_thread_count(threads);
+    GramDistancesTask<Output> task(centered, norms, panels, n, dimension, width, exact, out, threads);
+    parallel_for(tiles, task, threads);
+}
+
+template<class Container>
+GramDistances::
+GramDistances(const Container& points, bool exact, unsigned threads)
+{
+    size_t              n         = points.size();
+    size_t              dimension = n > 0 ? points[0].size() : 0;
+    std::vector<double> rows;     rows.reserve(n*dimension);
+    for (size_t i = 0; i < n; ++i)
+        rows.insert(rows.end(), points[i].begin(), points[i].end());
+    compute(rows.empty() ? 0 : &rows[0], n, dimension, exact, threads);
+}
@@ -0,0 +1,93 @@
+#ifndef __HARMONICS_H__
+#define __HARMONICS_H__
+
+#include <vector>
+#include <cmath>
+
+#include <utilities/types.h>
+
+/**
+ * Harmonics of a sequence of samples t_0, ..., t_{n-1}: the functions sin(w_k t), cos(w_k t) with w_k = 2 pi k for
+ * k = 1, ..., count, or their derivatives. The sines and the cosines of the multiples of an angle come from the
+ * angle-addition recurrence
+ *   sin((k+1)a) = sin(ka) cos(a) + cos(ka) sin(a),    cos((k+1)a) = cos(ka) cos(a) - sin(ka) sin(a),
+ * so a sample costs one call to sin() and cos() (instead of count of each). The rounding errors grow linearly in k,
+ * which is negligible for the few dozen harmonics of a regression model.
+ *
+ * The d-th derivative of the pair (sin(wt), cos(wt)) is w^d times the pair rotated by d quarter turns:
+ * (cos(wt), -sin(wt)) for d = 1, (-sin(wt), -cos(wt)) for d = 2, and so on. The weights w_k^d are computed once,
+ * in the constructor.
+ */
+template<class Real>
+class Harmonics
+{
+    public:
+                        Harmonics(unsigned count, unsigned derivative = 0):
+                            count_(count), derivative_(derivative), weights_(count)
+        {
+            for (unsigned k = 1; k <= count_; ++k)
+            {
+                Real w = 1;
+                for (unsigned d = 0; d < derivative_; ++d)
+                    w *= TwoPi*k;
+                weights_[k-1] = w;
+            }
+        }
+
+        unsigned        count() const                                       { return count_; }
+        unsigned        derivative() const                                  { return derivative_; }
+
+        // Writes the 2*count values of the (derivatives of the) harmonics at t, in the order
+        // sin(w_1 t), cos(w_1 t), ..., sin(w_count t), cos(w_count t), into out[0], ..., out[2*count - 1]
+        template<class OutputIterator>
+        void            operator()(Real t, OutputIterator out) const
+        {
+            Real        s1 = std::sin(TwoPi*t), c1 = std::cos(TwoPi*t);
+            Real        s = s1, c = c1;
+            for (unsigned k = 1; k <= count_; ++k)
+            {
+                Real w = weights_[k-1];
+                switch (derivative_ % 4)
+                {
+                    case 0: *out++ =  w*s; *out++ =  w*c; break;
+                    case 1: *out++ =  w*c; *out++ = -w*s; break;
+                    case 2: *out++ = -w*s; *out++ = -w*c; break;
+                    case 3: *out++ = -w*c; *out++ =  w*s; break;
+                }
+                Real s_next = s*c1 + c*s1;
+                c           = c*c1 - s*s1;
+                s           = s_next;
+            }
+        }
+
+        // The n by 2*count matrix (in the row-major order) of the harmonics at all the samples
+        void            matrix(const std::vector<Real>& t, std::vector<Real>& out) const
+        {
+            out.resize(t.size()*2*count_);
+            for (size_t i = 0; i < t.size(); ++i)
+                (*this)(t[i], out.begin() + i*2*count_);
+        }
+
+        // out_i = sum_j coefficients[j] h_j(t_i), the linear combination of the harmonics with the 2*count coefficients,
+        // without the matrix
+        void            combination(const std::vector<Real>& t, const std::vector<Real>& coefficients, std::vector<Real>& out) const
+        {
+            std::vector<Real>   row(2*count_);
+            out.resize(t.size());
+            for (size_t i = 0; i < t.size(); ++i)
+            {
+                (*this)(t[i], row.begin());
+                Real sum = 0;
+                for (unsigned j = 0; j < 2*count_; ++j)
+                    sum += coefficients[j]*row[j];
+                out[i] = sum;
+            }
+        }
+
+    private:
+        unsigned        count_;
+        unsigned        derivative_;
+        std::vector<Real>   weights_;                                       // w_k^derivative
+};
+
+#endif // __HARMONICS_H__
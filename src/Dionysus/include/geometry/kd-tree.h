@@ -0,0 +1,63 @@
+#ifndef __KD_TREE_H__
+#define __KD_TREE_H__
+
+#include <vector>
+#include <algorithm>
+
+
+/**
+ * Class: KDTree
+ * kd-tree over n points in R^dimension (the rows of a row-major array) for the queries of the points within a radius
+ * (in the Euclidean metric). Every node splits its points at the median of the coordinate of the largest spread, down
+ * to the leaves of at most leaf_size points, whose coordinates are stored together in the order of the leaves. A query
+ * descends into the nearer child first, and into the farther one only if the box of the child, bounded incrementally
+ * by the offsets of the query from the splits on the way down (Arya and Mount), reaches within the radius, so for a
+ * small radius it looks at a few leaves instead of all the points.
+ *
+ * As the candidates of NeighborGraph, it finds the edges of a Rips complex up to max without evaluating all the pairs.
+ */
+class KDTree
+{
+    public:
+                            KDTree(const double* points, size_t n, size_t dimension, size_t leaf_size = 16);
+
+        size_t              size() const                                    { return order_.size(); }
+        size_t              dimension() const                               { return dimension_; }
+
+        // Appends the indices of the points within radius of q to out (the rounding may let in the points a hair beyond it)
+        template<class Index>
+        void                radius(const double* q, double radius, std::vector<Index>& out) const
+        { query(q, radius, out, 0, false); }
+
+        // Candidates for NeighborGraph: appends the indices b > a of the points within max of the point a to out
+        template<class Index>
+        void                operator()(size_t a, double max, std::vector<Index>& out) const
+        { query(&points_[positions_[a]*dimension_], max, out, a, true); }
+
+    private:
+        struct Node
+        {
+            size_t          begin, end;                                     // the positions of the points in the subtree
+            size_t          left, right;                                    // the children (0 for a leaf; the root is 0)
+            size_t          coordinate;
+            double          split;                                          // the left child has the points with the coordinate
+        };                                                                  // at most split, the right one at least split
+
+        size_t              build(const double* points, size_t begin, size_t end);
+
+        template<class Index>
+        void                query(const double* q, double radius, std::vector<Index>& out, size_t above, bool only_above) const;
+        template<class Index>
+        void                search(size_t node, const double* q, double r2, double reach, std::vector<double>& offsets,
+                                   std::vector<Index>& out, size_t above, bool only_above) const;
+
+        size_t                  dimension_, leaf_size_;
+        std::vector<size_t>     order_;                                     // the index of the point at every position
+        std::vector<size_t>     positions_;                                 // the position of every point
+        std::vector<double>     points_;                                    // the coordinates by positions
+        std::vector<Node>       nodes_;
+};
+
+#include "kd-tree.hpp"
+
+#endif // __KD_TREE_H__
@@ -0,0 +1,121 @@
+// Orders the positions by a coordinate of their points
+struct KDTreeCoordinateLess
+{
+                    KDTreeCoordinateLess(const double* points, size_t dimension, size_t coordinate):
+                        points_(points), dimension_(dimension), coordinate_(coordinate)    {}
+
+    bool            operator()(size_t a, size_t b) const            { return points_[a*dimension_ + coordinate_] < points_[b*dimension_ + coordinate_]; }
+
+    const double*   points_;
+    size_t          dimension_, coordinate_;
+};
+
+inline
+KDTree::
+KDTree(const double* points, size_t n, size_t dimension, size_t leaf_size):
+    dimension_(dimension), leaf_size_(std::max<size_t>(leaf_size, 1)), order_(n), positions_(n), points_(n*dimension)
+{
+    for (size_t i = 0; i < n; ++i)
+        order_[i] = i;
+    if (n > 0)
+        build(points, 0, n);
+
+    for (size_t p = 0; p < n; ++p)
+    {
+        positions_[order_[p]] = p;
+        std::copy(points + order_[p]*dimension, points + (order_[p] + 1)*dimension, points_.begin() + p*dimension);
+    }
+}
+
+inline size_t
+KDTree::
+build(const double* points, size_t begin, size_t end)
+{
+    size_t  node = nodes_.size();
+    Node    n    = { begin, end, 0, 0, 0, 0 };
+    nodes_.push_back(n);
+    if (end - begin <= leaf_size_)
+        return node;
+
+    // the coordinate of the largest spread
+    double  spread = 0;
+    for (size_t k = 0; k < dimension_; ++k)
+    {
+        double lo = points[order_[begin]*dimension_ + k], hi = lo;
+        for (size_t p = begin + 1; p < end; ++p)
+        {
+            double x = points[order_[p]*dimension_ + k];
+            lo = std::min(lo, x);
+            hi = std::max(hi, x);
+        }
+        if (hi - lo > spread)
+        {
+            spread = hi - lo;
+            nodes_[node].coordinate = k;
+        }
+    }
+    if (spread == 0)                                    // all the points are the same
+        return node;
+
+    size_t middle = begin + (end - begin)/2;
+    std::nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end,
+                     KDTreeCoordinateLess(points, dimension_, nodes_[node].coordinate));
+    nodes_[node].split = points[order_[middle]*dimension_ + nodes_[node].coordinate];
+
+    size_t left  = build(points, begin, middle);
+    size_t right = build(points, middle, end);
+    nodes_[node].left  = left;
+    nodes_[node].right = right;
+    return node;
+}
+
+template<class Index>
+void
+KDTree::
+query(const double* q, double radius, std::vector<Index>& out, size_t above, bool only_above) const
+{
+    if (nodes_.empty() || radius < 0)
+        return;
+    std::vector<double> offsets(dimension_, 0);
+    double r2 = radius*radius*(1 + 1e-9);               // a little slack, so that the rounding never drops a point
+    search(0, q, r2, 0, offsets, out, above, only_above);
+}
+
+template<class Index>
+void
+KDTree::
+search(size_t node, const double* q, double r2, double reach, std::vector<double>& offsets,
+       std::vector<Index>& out, size_t above, bool only_above) const
+{
+    const Node& n = nodes_[node];
+    if (n.left == 0)
+    {
+        for (size_t p = n.begin; p < n.end; ++p)
+        {
+            if (only_above && order_[p] <= above)
+                continue;
+            const double*   x   = &points_[p*dimension_];
+            double          sum = 0;
+            for (size_t k = 0; k < dimension_ && sum <= r2; ++k)
+                sum += (q[k] - x[k])*(q[k] - x[k]);
+            if (sum <= r2)
+                out.push_back(order_[p]);
+        }
+        return;
+    }
+
+    double  difference = q[n.coordinate] - n.split;
+    size_t  nearer     = difference <= 0 ? n.left  : n.right;
+    size_t  farther    = difference <= 0 ? n.right : n.left;
+    search(nearer, q, r2, reach, offsets, out, above, only_above);
+
+    // the farther box is at least |difference| away along the coordinate (instead of the old offset)
+    double  old        = offsets[n.coordinate];
+    double  far_reach  = reach - old*old + difference*difference;
+    if (far_reach <= r2)
+    {
+        offsets[n.coordinate] = difference;
+        search(farther, q, r2, far_reach, offsets, out, above, only_above);
+        offsets[n.coordinate] = old;
+    }
+}
@@ -4,6 +4,9 @@
 #include <utilities/types.h>
 #include <utilities/log.h>
 
+#include "distances.h"
+#include "gram-distances.h"
+
 #include <vector>
 #include <fstream>
 #include <functional>
@@ -29,6 +32,37 @@ struct L2Distance:
     }
 };
 
+// Stores the distances computed by gram_distances() at the positions of ExplicitDistances
+struct ExplicitDistancesOutput
+{
+                    ExplicitDistancesOutput(std::vector<double>& out, size_t size):
+                        out_(out), size_(size)                      {}
+
+    void            operator()(size_t a, size_t b, double d) const  { out_[a*size_ - (a*(a-1))/2 + (b-a)] = d; }
+
+    std::vector<double>&    out_;
+    size_t                  size_;
+};
+
+// ExplicitDistances of the points with L2Distance are all computed at once, with gram_distances() in its exact mode (so they
+// are the same as L2Distance's, ties included), on the calling thread; GramDistances has the faster approximate mode and all the cores
+template<class Index>
+void    fill_explicit_distances(const PairwiseDistances<PointContainer, L2Distance, Index>& distances, std::vector<double>& out)
+{
+    const PointContainer&   points    = distances.container();
+    size_t                  n         = points.size();
+    size_t                  dimension = n > 0 ? points[0].size() : 0;
+    std::vector<double>     rows;       rows.reserve(n*dimension);
+    for (size_t i = 0; i < n; ++i)
+    {
+        AssertMsg(points[i].size() == dimension, "Points must be in the same dimension (in L2Distance): dim1=%d, dim2=%d", dimension, points[i].size());
+        rows.insert(rows.end(), points[i].begin(), points[i].end());
+    }
+
+    ExplicitDistancesOutput output(out, n);
+    gram_distances(rows.empty() ? 0 : &rows[0], n, dimension, output, true, 1);
+}
+
 void    read_points(const std::string& infilename, PointContainer& points)
 {
     std::ifstream in(infilename.c_str());
@@ -0,0 +1,114 @@
+#ifndef __MAPPED_DISTANCES_H__
+#define __MAPPED_DISTANCES_H__
+
+#include <string>
+#include <algorithm>
+#include <stdint.h>
+
+#include <boost/noncopyable.hpp>
+
+
+/**
+ * Struct: MappedDistancesHeader
+ * The first 64 bytes of a file of MappedDistances. The values follow it, in the native byte order.
+ */
+struct MappedDistancesHeader
+{
+    char            magic[8];                                       // "DIONDIST"
+    uint32_t        version;                                        // 1
+    uint32_t        type;                                           // MappedDistances::ValueType
+    uint32_t        layout;                                         // MappedDistances::Layout
+    uint32_t        reserved;
+    uint64_t        size;                                           // the number of the points
+    uint64_t        key;                                            // what the distances are of (0 if unknown; see write())
+    char            padding[24];
+};
+
+
+/**
+ * Class: MappedDistances
+ * The pairwise distances of n points, read from a file through a read-only memory mapping, so that they need not fit in
+ * memory, and can be computed once and reused by later runs (e.g., of a sweep over the parameters of a Rips complex).
+ * A Distances template argument for Rips, like ExplicitDistances.
+ *
+ * The file is a MappedDistancesHeader followed by the values, either float64 or float32 (which halves the file), in one of
+ * the layouts:
+ *  - condensed: d(i,j) for i < j in the row-major order (as scipy.spatial.distance.pdist() returns it), n(n-1)/2 values;
+ *  - upper:     d(i,j) for i <= j in the row-major order (as ExplicitDistances stores them), n(n+1)/2 values.
+ *
+ * There are no exceptions: a file that cannot be opened, or is not a file of distances, leaves the instance invalid,
+ * with the reason in error(); write() returns false (and the reason in its error argument) instead.
+ */
+class MappedDistances: private boost::noncopyable
+{
+    public:
+        typedef             size_t                                          IndexType;
+        typedef             double                                          DistanceType;
+
+        enum                ValueType                                       { float64 = 0, float32 = 1 };
+        enum                Layout                                          { condensed = 0, upper = 1 };
+
+                            MappedDistances(const std::string& filename);
+                            ~MappedDistances();
+
+        // Computes the distances of distances into the file filename, row after row on threads threads (0 for all the
+        // cores), through a writable mapping, so that they are never all in memory either. The key is stored with them,
+        // e.g., a hash of the points and the metric, so that a later run can tell whether the file is of its points.
+        template<class Distances>
+        static bool         write(const std::string& filename, const Distances& distances,
+                                  ValueType type = float64, Layout layout = condensed, uint64_t key = 0,
+                                  unsigned threads = 0, std::string* error = 0);
+
+        DistanceType        operator()(IndexType a, IndexType b) const
+        {
+            if (a > b) std::swap(a, b);
+            if (a == b && layout_ == condensed)
+                return 0;
+            size_t i = index(a, b, size_, layout_);
+            return type_ == float64 ? static_cast<const double*>(values_)[i] : static_cast<const float*>(values_)[i];
+        }
+
+        size_t              size() const                                    { return size_; }
+        IndexType           begin() const                                   { return 0; }
+        IndexType           end() const                                     { return size(); }
+
+        bool                valid() const                                   { return data_ != 0; }
+        const std::string&  error() const                                   { return error_; }
+
+        uint64_t            key() const                                     { return key_; }
+        ValueType           value_type() const                              { return type_; }
+        Layout              layout() const                                  { return layout_; }
+
+        // Position of d(a,b), a <= b (a < b for condensed), among the values
+        static size_t       index(size_t a, size_t b, size_t n, Layout layout)
+        { return layout == condensed ? a*n - a*(a+1)/2 + (b - a - 1) : a*n - (a*(a-1))/2 + (b - a); }
+
+        // The number of the values, and the bytes of the file, of n points
+        static size_t       count(size_t n, Layout layout)                  { return layout == condensed ? n*(n - (n > 0))/2 : n*(n+1)/2; }
+        static size_t       bytes(size_t n, ValueType type, Layout layout)  { return sizeof(MappedDistancesHeader) + count(n, layout)*width(type); }
+        static size_t       width(ValueType type)                           { return type == float64 ? sizeof(double) : sizeof(float); }
+
+    private:
+        template<class Distances>
+        class               RowTask;
+
+        // The mapping of the whole file: read-only, or (with create) of a new file of length bytes, writable; 0 if it fails.
+        // The only parts that differ between POSIX (mmap) and Windows (MapViewOfFile).
+        static void*        map(const std::string& filename, size_t& length, bool create, std::string& error);
+        static void         unmap(void* data, size_t length);
+        static bool         sync(void* data, size_t length, const std::string& filename, std::string& error);
+        static std::string  system_error(const std::string& filename);
+
+        void*               data_;                                          // the whole mapping
+        size_t              length_;
+        const void*         values_;
+        size_t              size_;
+        ValueType           type_;
+        Layout              layout_;
+        uint64_t            key_;
+        std::string         error_;
+};
+
+#include "mapped-distances.hpp"
+
+#endif // __MAPPED_DISTANCES_H__
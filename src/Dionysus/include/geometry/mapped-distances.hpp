@@ -0,0 +1,253 @@
+#include <utilities/parallel.h>
+
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+
+#if _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX                                        // std::min and std::max stay usable
+#endif
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+static const char   mapped_distances_magic[8]   = { 'D', 'I', 'O', 'N', 'D', 'I', 'S', 'T' };
+static const uint32_t mapped_distances_version  = 1;
+
+#if _WIN32
+
+inline std::string
+MappedDistances::
+system_error(const std::string& filename)
+{
+    std::ostringstream out;
+    out << filename << ": system error " << GetLastError();
+    return out.str();
+}
+
+inline void*
+MappedDistances::
+map(const std::string& filename, size_t& length, bool create, std::string& error)
+{
+    HANDLE file = CreateFileA(filename.c_str(), create ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, create ? 0 : FILE_SHARE_READ,
+                              0, create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        error = system_error(filename);
+        return 0;
+    }
+
+    if (!create)
+    {
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || static_cast<size_t>(size.QuadPart) < sizeof(MappedDistancesHeader))
+        {
+            error = filename + ": not a file of distances (too short)";
+            CloseHandle(file);
+            return 0;
+        }
+        length = static_cast<size_t>(size.QuadPart);
+    }
+
+    // with create, the mapping extends the file to length
+    unsigned long long  size    = length;
+    HANDLE              mapping = CreateFileMappingA(file, 0, create ? PAGE_READWRITE : PAGE_READONLY,
+                                                     DWORD(size >> 32), DWORD(size & 0xffffffff), 0);
+    void*               data    = mapping ? MapViewOfFile(mapping, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, length) : 0;
+    if (!data)
+        error = system_error(filename);
+    if (mapping)
+        CloseHandle(mapping);                           // the view stays
+    CloseHandle(file);
+    return data;
+}
+
+inline void
+MappedDistances::
+unmap(void* data, size_t)
+{ UnmapViewOfFile(data); }
+
+inline bool
+MappedDistances::
+sync(void* data, size_t length, const std::string& filename, std::string& error)
+{
+    if (FlushViewOfFile(data, length))
+        return true;
+    error = system_error(filename);
+    return false;
+}
+
+#else
+
+inline std::string
+MappedDistances::
+system_error(const std::string& filename)
+{ return filename + ": " + std::strerror(errno); }
+
+inline void*
+MappedDistances::
+map(const std::string& filename, size_t& length, bool create, std::string& error)
+{
+    int fd = create ? ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) : ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = system_error(filename);
+        return 0;
+    }
+
+    struct stat st;
+    if (create ? ::ftruncate(fd, length) != 0 : ::fstat(fd, &st) != 0)
+    {
+        error = system_error(filename);
+        ::close(fd);
+        return 0;
+    }
+    if (!create)
+    {
+        if (static_cast<size_t>(st.st_size) < sizeof(MappedDistancesHeader))
+        {
+            error = filename + ": not a file of distances (too short)";
+            ::close(fd);
+            return 0;
+        }
+        length = st.st_size;
+    }
+
+    void* data = ::mmap(0, length, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);                                        // the mapping stays
+    if (data == MAP_FAILED)
+    {
+        error = system_error(filename);
+        return 0;
+    }
+    return data;
+}
+
+inline void
+MappedDistances::
+unmap(void* data, size_t length)
+{ ::munmap(data, length); }
+
+inline bool
+MappedDistances::
+sync(void* data, size_t length, const std::string& filename, std::string& error)
+{
+    if (::msync(data, length, MS_SYNC) == 0)
+        return true;
+    error = system_error(filename);
+    return false;
+}
+
+#endif
+
+inline
+MappedDistances::
+MappedDistances(const std::string& filename):
+    data_(0), length_(0), values_(0), size_(0), type_(float64), layout_(condensed), key_(0)
+{
+    void* data = map(filename, length_, false, error_);
+    if (!data)
+        return;
+
+    const MappedDistancesHeader& header = *static_cast<const MappedDistancesHeader*>(data);
+    if (std::memcmp(header.magic, mapped_distances_magic, sizeof(header.magic)) != 0)
+        error_ = filename + ": not a file of distances (or an unfinished one)";
+    else if (header.version != mapped_distances_version)
+        error_ = filename + ": unknown version of the file of distances";
+    else if (header.type > float32 || header.layout > upper)
+        error_ = filename + ": unknown type or layout of the distances";
+    else if (length_ != bytes(header.size, ValueType(header.type), Layout(header.layout)))
+        error_ = filename + ": the length of the file does not match its number of points";
+    if (!error_.empty())
+    {
+        unmap(data, length_);
+        return;
+    }
+
+    data_   = data;
+    values_ = static_cast<const char*>(data) + sizeof(MappedDistancesHeader);
+    size_   = header.size;
+    type_   = ValueType(header.type);
+    layout_ = Layout(header.layout);
+    key_    = header.key;
+}
+
+inline
+MappedDistances::
+~MappedDistances()
+{
+    if (data_)
+        unmap(data_, length_);
+}
+
+// Fills the values of the row a
+template<class Distances>
+class MappedDistances::RowTask
+{
+    public:
+                            RowTask(const Distances& distances, void* values, size_t n, ValueType type, Layout layout):
+                                distances_(distances), values_(values), n_(n), type_(type), layout_(layout)     {}
+
+        void                operator()(size_t a, unsigned) const
+        {
+            typedef         typename Distances::IndexType           Index;
+            size_t          b = layout_ == condensed ? a + 1 : a;
+            if (b >= n_)
+                return;
+
+            size_t          i = index(a, b, n_, layout_);
+            if (type_ == float64)
+                for (double* out = static_cast<double*>(values_) + i; b < n_; ++b)
+                    *out++ = distances_(Index(a), Index(b));
+            else
+                for (float* out = static_cast<float*>(values_) + i; b < n_; ++b)
+                    *out++ = distances_(Index(a), Index(b));
+        }
+
+    private:
+        const Distances&    distances_;
+        void*               values_;
+        size_t              n_;
+        ValueType           type_;
+        Layout              layout_;
+};
+
+template<class Distances>
+bool
+MappedDistances::
+write(const std::string& filename, const Distances& distances, ValueType type, Layout layout, uint64_t key, unsigned threads,
+      std::string* error)
+{
+    size_t  n      = distances.size();
+    size_t  length = bytes(n, type, layout);
+
+    std::string ignored, &message = error ? *error : ignored;
+    void* data = map(filename, length, true, message);
+    if (!data)
+        return false;
+
+    RowTask<Distances> task(distances, static_cast<char*>(data) + sizeof(MappedDistancesHeader), n, type, layout);
+    parallel_for(n, task, threads);
+
+    // The header goes in last, so that an interrupted write never leaves a file that opens
+    MappedDistancesHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, mapped_distances_magic, sizeof(header.magic));
+    header.version = mapped_distances_version;
+    header.type    = type;
+    header.layout  = layout;
+    header.size    = n;
+    header.key     = key;
+    std::memcpy(data, &header, sizeof(header));
+
+    bool synced = sync(data, length, filename, message);
+    unmap(data, length);
+    return synced;
+}
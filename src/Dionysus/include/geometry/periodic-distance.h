@@ -0,0 +1,89 @@
+#ifndef __PERIODIC_DISTANCE_H__
+#define __PERIODIC_DISTANCE_H__
+
+#include <utilities/log.h>
+#include <utilities/types.h>
+
+#include <vector>
+#include <functional>
+#include <cmath>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+/**
+ * Function: periodic_squared_distance(a, b, periods, inverse_periods, dimension)
+ * Squared Euclidean distance between the points a and b (dimension coordinates each) on a product of circles and lines:
+ * the coordinate k with periods[k] > 0 is an angle on the circle of that length, and the difference of two angles is
+ * taken the shorter way around, a_k - b_k - periods[k]*round((a_k - b_k)/periods[k]), which is in [-periods[k]/2, periods[k]/2];
+ * the coordinate with periods[k] = 0 is on a line. inverse_periods[k] is 1/periods[k] (0 for a line), so both kinds of
+ * coordinates go through the same branchless loop, four at a time with AVX2 (when compiled with it).
+ */
+inline double
+periodic_squared_distance(const double* a, const double* b, const double* periods, const double* inverse_periods, size_t dimension)
+{
+    double  sum = 0;
+    size_t  k   = 0;
+#ifdef __AVX2__
+    __m256d s = _mm256_setzero_pd();
+    for (; k + 4 <= dimension; k += 4)
+    {
+        __m256d d     = _mm256_sub_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k));
+        __m256d turns = _mm256_round_pd(_mm256_mul_pd(d, _mm256_loadu_pd(inverse_periods + k)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        d = _mm256_sub_pd(d, _mm256_mul_pd(turns, _mm256_loadu_pd(periods + k)));
+        s = _mm256_add_pd(s, _mm256_mul_pd(d, d));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, s);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; k < dimension; ++k)
+    {
+        double d = a[k] - b[k];
+        d -= periods[k]*std::floor(d*inverse_periods[k] + .5);
+        sum += d*d;
+    }
+    return sum;
+}
+
+
+/**
+ * Class: PeriodicL2Distance
+ * Distance functor (e.g., for PairwiseDistances) on the flat torus of angles, optionally times a Euclidean space: the
+ * Euclidean distance with the differences of the angles taken modulo their periods (see periodic_squared_distance()).
+ * For Euler angles in radians (period 2 pi), the rotations by pi and by -pi are the same point, instead of 2 pi apart.
+ */
+struct PeriodicL2Distance:
+    public std::binary_function<const std::vector<double>&, const std::vector<double>&, double>
+{
+                    // All of the dimension coordinates are angles with the same period
+                    PeriodicL2Distance(size_t dimension, double period = TwoPi):
+                        periods_(dimension, period),
+                        inverse_periods_(dimension, period > 0 ? 1/period : 0)     {}
+
+                    // The coordinate k has the period periods[k] (0 makes it Euclidean)
+                    PeriodicL2Distance(const std::vector<double>& periods):
+                        periods_(periods), inverse_periods_(periods.size())
+    {
+        for (size_t k = 0; k < periods_.size(); ++k)
+            inverse_periods_[k] = periods_[k] > 0 ? 1/periods_[k] : 0;
+    }
+
+    result_type     operator()(const std::vector<double>& p1, const std::vector<double>& p2) const
+    {
+        AssertMsg(p1.size() == p2.size(), "Points must be in the same dimension (in PeriodicL2Distance): dim1=%d, dim2=%d", p1.size(), p2.size());
+        AssertMsg(p1.size() == periods_.size(), "Points must have a period per coordinate (in PeriodicL2Distance): dim=%d, periods=%d", p1.size(), periods_.size());
+        if (p1.empty())
+            return 0;
+        return std::sqrt(periodic_squared_distance(&p1[0], &p2[0], &periods_[0], &inverse_periods_[0], p1.size()));
+    }
+
+    const std::vector<double>&  periods() const                                     { return periods_; }
+
+    std::vector<double>         periods_;
+    std::vector<double>         inverse_periods_;
+};
+
+#endif // __PERIODIC_DISTANCE_H__
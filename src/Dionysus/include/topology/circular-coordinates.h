@@ -0,0 +1,123 @@
+#ifndef __CIRCULAR_COORDINATES_H__
+#define __CIRCULAR_COORDINATES_H__
+
+#include <vector>
+
+#include "simplex-key.h"
+#include "utilities/types.h"
+
+
+/**
+ * Class: SparseMatrix
+ * Real matrix in the compressed sparse row form: the entries of row i are in the positions
+ * offsets[i], ..., offsets[i+1] - 1 of columns and values. The rows are filled in order with add() and end_row().
+ */
+struct SparseMatrix
+{
+    typedef             double                                          Real;
+    typedef             std::vector<Real>                               RealVector;
+
+                        SparseMatrix(size_t cols = 0):
+                            cols_(cols), offsets(1, 0)                  {}
+
+    size_t              rows() const                                    { return offsets.size() - 1; }
+    size_t              cols() const                                    { return cols_; }
+    size_t              nonzeros() const                                { return columns.size(); }
+
+    void                add(unsigned column, Real value)                { columns.push_back(column); values.push_back(value); }
+    void                end_row()                                       { offsets.push_back(columns.size()); }
+
+    // y = A*x and y = A^T*x for the first rows of A (all of them by default)
+    void                multiply(const RealVector& x, RealVector& y, size_t rows = -1) const;
+    void                multiply_transpose(const RealVector& x, RealVector& y, size_t rows = -1) const;
+
+    size_t              cols_;
+    std::vector<size_t> offsets;
+    std::vector<unsigned> columns;
+    RealVector          values;
+};
+
+
+/**
+ * Class: IncompleteCholesky
+ * Incomplete Cholesky factorization with no fill-in, IC(0): G G^T approximates A + shift*diag(A) for a symmetric matrix A
+ * (with sorted rows) and the lower triangular G with the pattern of the lower triangle of A. For a graph Laplacian
+ * (singular, but an M-matrix) the shift makes the factorization exist; the rows that would get a non-positive pivot
+ * anyway (the isolated vertices) get 1 on the diagonal.
+ */
+struct IncompleteCholesky
+{
+    typedef             SparseMatrix::Real                              Real;
+
+                        IncompleteCholesky(const SparseMatrix& a, Real shift = 1e-2);
+
+    // x = (G G^T)^{-1} x for the vector at x[0], x[stride], ..., x[(n-1)*stride]
+    void                solve(Real* x, size_t stride = 1) const;
+
+    SparseMatrix        g;                                              // the diagonal comes last in every row
+};
+
+
+/**
+ * Class: CircularCoordinates
+ * Circular coordinates of the vertices of a complex from its 1-cocycles (with integer coefficients, e.g., the lifts
+ * of the cocycles over Z_p with the coefficients in (-p/2, p/2]). A cocycle z is smoothed into the harmonic cocycle
+ * z - d_0 x of the same class, and x modulo 1 maps the vertices to the circle. The coboundaries d_0 (from the vertices
+ * to the edges) and d_1 (from the edges to the triangles) are kept in the compressed sparse row form, and x solves the
+ * normal equations L x = d_0^T z, where L = d_0^T d_0 is the Laplacian of the graph of the edges, by the conjugate
+ * gradient method, preconditioned with the IncompleteCholesky factorization of L by default. At the end, the mean of x
+ * over every connected component is subtracted, which leaves d_0 x as it is and gives the solution of the smallest norm,
+ * the same one as LSQR on d_0 (which is what the Python smooth() computes).
+ *
+ * The edges and the triangles are indexed in the order of the sequence the complex comes from, so for a filtration
+ * every prefix of it is a subcomplex whose coboundaries are the leading rows of d_0 and d_1. The cocycles that live
+ * in different prefixes (e.g., that die at different times) share one CircularCoordinates, and are smoothed together.
+ */
+class CircularCoordinates
+{
+    public:
+        typedef             SparseMatrix::Real                              Real;
+        typedef             SparseMatrix::RealVector                        RealVector;
+
+        // The complex consists of the simplices in [bg, end) (with sorted vertices(), and the faces of every simplex before it)
+        // on the vertices 0, ..., vertices - 1; the simplices of dimension above 2 are skipped
+        template<class Iterator>
+                            CircularCoordinates(Iterator bg, Iterator end, size_t vertices);
+
+        size_t              vertices() const                                { return d0_.cols(); }
+        size_t              edges() const                                   { return d0_.rows(); }
+        size_t              triangles() const                               { return d1_.rows(); }
+
+        // Index of the i-th simplex of the sequence passed to the constructor among the simplices of its dimension
+        // (vertices are indexed by themselves); -1 if it was skipped
+        int                 index(size_t i) const                           { return indices_[i]; }
+
+        // Coboundary from the d-dimensional simplices (d is 0 or 1)
+        const SparseMatrix& coboundary(Dimension d) const                   { return d == 0 ? d0_ : d1_; }
+        // Laplacian of the graph of the first edges (all of them by default), with the sorted rows
+        SparseMatrix        laplacian(size_t edges = -1) const;
+
+        // Whether z (with a value per edge) is a cocycle on the first triangles (all of them by default), i.e., |d_1 z| <= tolerance on them
+        bool                cocycle(const RealVector& z, size_t triangles = -1, Real tolerance = 1e-10) const;
+
+        // Writes the vertex values x of the smoothing of the cocycle z into x; stops once |d_0^T (z - d_0 x)| <= tolerance*|d_0^T z|
+        // (or after max_iterations, by default ten times the number of vertices). Returns the number of iterations.
+        unsigned            smooth(const RealVector& z, RealVector& x, Real tolerance = 1e-10, unsigned max_iterations = 0,
+                                   bool precondition = true) const;
+        // Smooths all the cocycles z[0], ..., z[k-1] at once (x[i] is the smoothing of z[i] in the complex of the first
+        // edges[i] edges, where z[i] must vanish beyond them): the conjugate gradients run side by side, and every pass
+        // over the edges serves all of them. Returns the number of iterations of the slowest one.
+        unsigned            smooth(const std::vector<RealVector>& z, std::vector<RealVector>& x, const std::vector<size_t>& edges,
+                                   Real tolerance = 1e-10, unsigned max_iterations = 0, bool precondition = true) const;
+
+        // |d_0^T (z - d_0 x)| on the first edges (all of them by default), which is 0 iff z - d_0 x is harmonic there
+        Real                residual(const RealVector& z, const RealVector& x, size_t edges = -1) const;
+
+    private:
+        SparseMatrix        d0_, d1_;
+        std::vector<int>    indices_;
+};
+
+#include "circular-coordinates.hpp"
+
+#endif // __CIRCULAR_COORDINATES_H__
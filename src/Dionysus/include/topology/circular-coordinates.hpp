@@ -0,0 +1,382 @@
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+inline void
+SparseMatrix::
+multiply(const RealVector& x, RealVector& y, size_t rows) const
+{
+    rows = std::min(rows, this->rows());
+    y.resize(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        Real sum = 0;
+        for (size_t j = offsets[i]; j != offsets[i + 1]; ++j)
+            sum += values[j]*x[columns[j]];
+        y[i] = sum;
+    }
+}
+
+inline void
+SparseMatrix::
+multiply_transpose(const RealVector& x, RealVector& y, size_t rows) const
+{
+    rows = std::min(rows, this->rows());
+    y.assign(cols(), 0);
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = offsets[i]; j != offsets[i + 1]; ++j)
+            y[columns[j]] += values[j]*x[i];
+}
+
+
+inline
+IncompleteCholesky::
+IncompleteCholesky(const SparseMatrix& a, Real shift):
+    g(a.cols())
+{
+    size_t                      n = a.rows();
+    std::vector<Real>           row(n, 0);                  // the current row of G, scattered
+    std::vector<size_t>         diagonal(n);                // position of g_jj in g
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t begin = g.nonzeros();
+        Real pivot = 0;
+        for (size_t j = a.offsets[i]; j != a.offsets[i + 1]; ++j)
+            if (a.columns[j] < i)
+                g.add(a.columns[j], a.values[j]);
+            else if (a.columns[j] == i)
+                pivot = (1 + shift)*a.values[j];
+
+        // g_ij = (a_ij - sum_{k < j} g_ik g_jk)/g_jj, in the increasing order of j
+        for (size_t t = begin; t != g.nonzeros(); ++t)
+        {
+            size_t j = g.columns[t];
+            Real sum = g.values[t];
+            for (size_t u = g.offsets[j]; u != diagonal[j]; ++u)
+                sum -= row[g.columns[u]]*g.values[u];
+            g.values[t] = sum/g.values[diagonal[j]];
+            row[j] = g.values[t];
+            pivot -= g.values[t]*g.values[t];
+        }
+        for (size_t t = begin; t != g.nonzeros(); ++t)
+            row[g.columns[t]] = 0;
+
+        diagonal[i] = g.nonzeros();
+        g.add(i, pivot > 0 ? std::sqrt(pivot) : 1);
+        g.end_row();
+    }
+}
+
+inline void
+IncompleteCholesky::
+solve(Real* x, size_t stride) const
+{
+    size_t n = g.rows();
+    for (size_t i = 0; i < n; ++i)                          // G y = x
+    {
+        size_t diagonal = g.offsets[i + 1] - 1;
+        Real sum = x[i*stride];
+        for (size_t t = g.offsets[i]; t != diagonal; ++t)
+            sum -= g.values[t]*x[g.columns[t]*stride];
+        x[i*stride] = sum/g.values[diagonal];
+    }
+    for (size_t i = n; i-- > 0; )                           // G^T x = y
+    {
+        size_t diagonal = g.offsets[i + 1] - 1;
+        Real xi = x[i*stride] /= g.values[diagonal];
+        for (size_t t = g.offsets[i]; t != diagonal; ++t)
+            x[g.columns[t]*stride] -= g.values[t]*xi;
+    }
+}
+
+
+template<class Iterator>
+CircularCoordinates::
+CircularCoordinates(Iterator bg, Iterator end, size_t vertices):
+    d0_(vertices)
+{
+    SimplexKeys                 keys(vertices, 1);
+    SimplexKeyMap<unsigned>     edges(1);
+    SimplexKeys::Key            facets[3];
+
+    for (; bg != end; ++bg)
+    {
+        const typename std::iterator_traits<Iterator>::value_type::VertexContainer& v = bg->vertices();
+        switch (bg->dimension())
+        {
+            case 0:
+                indices_.push_back(v[0]);
+                break;
+            case 1:                                         // [u,v] -> [v] - [u]
+                indices_.push_back(d0_.rows());
+                edges.insert(1, keys.key(v.begin(), v.end()), d0_.rows());
+                d0_.add(v[0], -1); d0_.add(v[1], 1); d0_.end_row();
+                break;
+            case 2:                                         // [a,b,c] -> [b,c] - [a,c] + [a,b]
+            {
+                indices_.push_back(d1_.rows());
+                keys.boundary(v.begin(), v.end(), facets);
+                Real sign = 1;
+                for (unsigned i = 0; i < 3; ++i, sign = -sign)
+                {
+                    const unsigned* e = edges.find(1, facets[i]);
+                    AssertMsg(e, "The edges of a triangle must come before it");
+                    d1_.add(*e, sign);
+                }
+                d1_.end_row();
+                break;
+            }
+            default:
+                indices_.push_back(-1);
+        }
+    }
+    d1_.cols_ = d0_.rows();
+}
+
+inline SparseMatrix
+CircularCoordinates::
+laplacian(size_t edges) const
+{
+    // the degree on the diagonal, and -1 for every edge
+    edges = std::min(edges, this->edges());
+    size_t n = vertices();
+    std::vector<unsigned>       degrees(n, 0);
+    for (size_t e = 0; e < edges; ++e)
+    {
+        ++degrees[d0_.columns[2*e]];
+        ++degrees[d0_.columns[2*e + 1]];
+    }
+
+    SparseMatrix L(n);
+    L.offsets.resize(n + 1);
+    for (size_t u = 0; u < n; ++u)
+        L.offsets[u + 1] = L.offsets[u] + degrees[u] + 1;
+    L.columns.resize(L.offsets.back());
+    L.values.resize(L.offsets.back());
+
+    std::vector<size_t>         next(L.offsets.begin(), L.offsets.end() - 1);
+    for (size_t u = 0; u < n; ++u)
+    {
+        L.columns[next[u]] = u;
+        L.values[next[u]++] = degrees[u];
+    }
+    for (size_t e = 0; e < edges; ++e)
+    {
+        unsigned u = d0_.columns[2*e], v = d0_.columns[2*e + 1];
+        L.columns[next[u]] = v; L.values[next[u]++] = -1;
+        L.columns[next[v]] = u; L.values[next[v]++] = -1;
+    }
+
+    std::vector< std::pair<unsigned, Real> > row;
+    for (size_t u = 0; u < n; ++u)
+    {
+        row.clear();
+        for (size_t j = L.offsets[u]; j != L.offsets[u + 1]; ++j)
+            row.push_back(std::make_pair(L.columns[j], L.values[j]));
+        std::sort(row.begin(), row.end());
+        for (size_t j = 0; j < row.size(); ++j)
+        {
+            L.columns[L.offsets[u] + j] = row[j].first;
+            L.values[L.offsets[u] + j]  = row[j].second;
+        }
+    }
+
+    return L;
+}
+
+inline bool
+CircularCoordinates::
+cocycle(const RealVector& z, size_t triangles, Real tolerance) const
+{
+    RealVector dz;
+    d1_.multiply(z, dz, triangles);
+    Real norm = 0;
+    for (size_t i = 0; i < dz.size(); ++i)
+        norm += dz[i]*dz[i];
+    return std::sqrt(norm) <= tolerance;
+}
+
+inline CircularCoordinates::Real
+CircularCoordinates::
+residual(const RealVector& z, const RealVector& x, size_t edges) const
+{
+    RealVector r, b;
+    d0_.multiply(x, r, edges);
+    for (size_t i = 0; i < r.size(); ++i)
+        r[i] = z[i] - r[i];
+    d0_.multiply_transpose(r, b, edges);
+
+    Real norm = 0;
+    for (size_t i = 0; i < b.size(); ++i)
+        norm += b[i]*b[i];
+    return std::sqrt(norm);
+}
+
+inline unsigned
+CircularCoordinates::
+smooth(const RealVector& z, RealVector& x, Real tolerance, unsigned max_iterations, bool precondition) const
+{
+    std::vector<RealVector> zs(1, z), xs;
+    unsigned iterations = smooth(zs, xs, std::vector<size_t>(1, edges()), tolerance, max_iterations, precondition);
+    x.swap(xs[0]);
+    return iterations;
+}
+
+inline unsigned
+CircularCoordinates::
+smooth(const std::vector<RealVector>& z, std::vector<RealVector>& x, const std::vector<size_t>& edges,
+       Real tolerance, unsigned max_iterations, bool precondition) const
+{
+    size_t n = vertices(), k = z.size();
+    if (max_iterations == 0)
+        max_iterations = 10*n;
+
+    // the cocycles go in the order of decreasing number of edges, so edge e is in the complexes
+    // of the cocycles order[0], ..., order[active(e) - 1]
+    std::vector< std::pair<size_t, size_t> >   by_edges;
+    for (size_t l = 0; l < k; ++l)
+        by_edges.push_back(std::make_pair(std::min(edges[l], this->edges()), l));
+    std::sort(by_edges.begin(), by_edges.end());
+    std::reverse(by_edges.begin(), by_edges.end());
+
+    // one factorization per complex
+    std::vector<IncompleteCholesky>     factors;
+    std::vector<size_t>                 factor(k);
+    if (precondition)
+        for (size_t l = 0; l < k; ++l)
+        {
+            if (l == 0 || by_edges[l].first != by_edges[l - 1].first)
+                factors.push_back(IncompleteCholesky(laplacian(by_edges[l].first)));
+            factor[l] = factors.size() - 1;
+        }
+
+    // preconditioned conjugate gradient on L x = d_0^T z, starting from x = 0; the vectors of all the cocycles
+    // are interleaved (the entry of vertex i for the l-th cocycle in by_edges is at i*k + l)
+    RealVector  xs(n*k, 0), r(n*k), s, p, q(n*k), b;
+    RealVector  rr(k, 0), rs(k, 0), stop(k), pq(k), rr_next(k), rs_next(k), alpha(k), beta(k);
+    for (size_t l = 0; l < k; ++l)
+    {
+        d0_.multiply_transpose(z[by_edges[l].second], b, by_edges[l].first);
+        for (size_t i = 0; i < n; ++i)
+        {
+            r[i*k + l] = b[i];
+            rr[l] += b[i]*b[i];
+        }
+        stop[l] = tolerance*tolerance*rr[l];
+    }
+    s = r;
+    if (precondition)
+        for (size_t l = 0; l < k; ++l)
+            factors[factor[l]].solve(&s[l], k);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t l = 0; l < k; ++l)
+            rs[l] += r[i*k + l]*s[i*k + l];
+    p = s;
+
+    unsigned iteration = 0;
+    for (; iteration < max_iterations; ++iteration)
+    {
+        bool done = true;
+        for (size_t l = 0; l < k; ++l)
+            done &= !(rr[l] > stop[l]);
+        if (done)
+            break;
+
+        // q = L p, one pass over the edges for all the cocycles
+        std::fill(q.begin(), q.end(), 0);
+        size_t active = k;
+        for (size_t e = 0; e < this->edges(); ++e)
+        {
+            while (active > 0 && by_edges[active - 1].first <= e)
+                --active;
+            if (active == 0)
+                break;
+
+            size_t u = d0_.columns[2*e]*k, v = d0_.columns[2*e + 1]*k;
+            for (size_t l = 0; l < active; ++l)
+            {
+                Real d = p[v + l] - p[u + l];
+                q[v + l] += d;
+                q[u + l] -= d;
+            }
+        }
+
+        std::fill(pq.begin(), pq.end(), 0);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t l = 0; l < k; ++l)
+                pq[l] += p[i*k + l]*q[i*k + l];
+
+        // the converged cocycles stay where they are (alpha = beta = 0)
+        for (size_t l = 0; l < k; ++l)
+            alpha[l] = rr[l] > stop[l] ? rs[l]/pq[l] : 0;
+
+        std::fill(rr_next.begin(), rr_next.end(), 0);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t l = 0; l < k; ++l)
+            {
+                xs[i*k + l] += alpha[l]*p[i*k + l];
+                r[i*k + l]  -= alpha[l]*q[i*k + l];
+                rr_next[l]  += r[i*k + l]*r[i*k + l];
+            }
+
+        s = r;
+        if (precondition)
+            for (size_t l = 0; l < k; ++l)
+                if (rr[l] > stop[l])
+                    factors[factor[l]].solve(&s[l], k);
+        std::fill(rs_next.begin(), rs_next.end(), 0);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t l = 0; l < k; ++l)
+                rs_next[l] += r[i*k + l]*s[i*k + l];
+
+        for (size_t l = 0; l < k; ++l)
+            if (rr[l] > stop[l])
+            {
+                beta[l] = rs_next[l]/rs[l];
+                rr[l]   = rr_next[l];
+                rs[l]   = rs_next[l];
+            } else
+                beta[l] = 0;
+        for (size_t i = 0; i < n; ++i)
+            for (size_t l = 0; l < k; ++l)
+                p[i*k + l] = s[i*k + l] + beta[l]*p[i*k + l];
+    }
+
+    // the solution of the smallest norm has mean 0 on every connected component; the components
+    // grow with the edges, so they are merged (with union-find) from the smallest complex up
+    std::vector<size_t>     parent(n), component(n);
+    RealVector              sums(n);
+    std::vector<size_t>     sizes(n);
+    for (size_t i = 0; i < n; ++i)
+        parent[i] = i;
+    x.resize(k);
+    size_t e = 0;
+    for (size_t l = k; l-- > 0; )
+    {
+        for (; e < by_edges[l].first; ++e)
+        {
+            size_t u = d0_.columns[2*e], v = d0_.columns[2*e + 1];
+            while (parent[u] != u) u = parent[u] = parent[parent[u]];
+            while (parent[v] != v) v = parent[v] = parent[parent[v]];
+            parent[std::max(u, v)] = std::min(u, v);
+        }
+
+        std::fill(sums.begin(), sums.end(), 0);
+        std::fill(sizes.begin(), sizes.end(), 0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            size_t c = i;
+            while (parent[c] != c) c = parent[c] = parent[parent[c]];
+            component[i] = c;
+            sums[c] += xs[i*k + l];
+            ++sizes[c];
+        }
+
+        RealVector& xl = x[by_edges[l].second];
+        xl.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            xl[i] = xs[i*k + l] - sums[component[i]]/sizes[component[i]];
+    }
+
+    return iteration;
+}
@@ -18,6 +18,7 @@
 
 #include <topology/field-arithmetic.h>
 #include "utilities/types.h"
+#include "utilities/pool.h"
 
 #include <boost/optional.hpp>
 #include <boost/intrusive/list.hpp>
@@ -27,19 +28,36 @@ namespace bi = boost::intrusive;
 #include <boost/shared_ptr.hpp>
 
 
-template<class BirthInfo_, class SimplexData_ = Empty<>, class Field_ = ZpField>
+// Storage of the simplices and the cocycles in CohomologyPersistence: every one is a node of a list
+struct ListStorage
+{
+    template<class SHead>   struct Simplices                                            { typedef s::list<SHead>            type; };
+    template<class Cocycle> struct Cocycles                                             { typedef s::list<Cocycle>          type; };
+};
+
+// Both come from Pools (see utilities/pool.h): there is no overhead of the general purpose allocator per element,
+// the ones added one after another are next to each other in memory, and the simplices (which are never traversed)
+// are not linked. Makes CohomologyPersistence noncopyable.
+struct PooledStorage
+{
+    template<class SHead>   struct Simplices                                            { typedef PooledStore<SHead>        type; };
+    template<class Cocycle> struct Cocycles                                             { typedef PooledList<Cocycle>       type; };
+};
+
+template<class BirthInfo_, class SimplexData_ = Empty<>, class Field_ = ZpField, class Storage_ = ListStorage>
 class CohomologyPersistence
 {
     public:
         typedef             BirthInfo_                                                  BirthInfo;
         typedef             SimplexData_                                                SimplexData;
         typedef             Field_                                                      Field;
+        typedef             Storage_                                                    Storage;
 
         typedef             typename Field::Element                                     FieldElement;
 
 
                             CohomologyPersistence(const Field& field = Field()):
-                                field_(field), image_begin_(cocycles_.end())            {}
+                                image_begin_(cocycles_.end()), field_(field), next_order_(0)    {}
 
 
         // An entry in a cocycle column
@@ -49,11 +67,11 @@ class CohomologyPersistence
         class   CompareSNode;
 
         struct  SHead;      // members: row, order
-        typedef             s::list<SHead>                                              Simplices;
+        typedef             typename Storage::template Simplices<SHead>::type           Simplices;
         typedef             typename Simplices::iterator                                SimplexIndex;
 
         struct  Cocycle;    // members: zcolumn, birth, order
-        typedef             s::list<Cocycle>                                            Cocycles;
+        typedef             typename Storage::template Cocycles<Cocycle>::type          Cocycles;
         typedef             typename Cocycles::iterator                                 CocycleIndex;
         typedef             std::pair<CocycleIndex, FieldElement>                       CocycleCoefficientPair;
 
@@ -63,6 +81,8 @@ class CohomologyPersistence
 
         // return either a SimplexIndex or a Death
         // BI = BoundaryIterator; it should dereference to a SimplexIndex
+        // if store is false and the simplex is born, neither it nor its class is kept, and the returned index is end();
+        // a simplex that kills a class is always kept (a caller that no longer needs it may clear() it)
         template<class BI>
         IndexDeathCocycle   add(BI begin, BI end, BirthInfo b, bool store = true, const SimplexData& sd = SimplexData(), bool image = true);
         
@@ -70,23 +90,49 @@ class CohomologyPersistence
         template<class BI, class CI>
         IndexDeathCocycle   add(CI coefficient_iter, BI begin, BI end, BirthInfo b, bool store = true, const SimplexData& sd = SimplexData(), bool image = true);
 
+        // Adds a simplex that is known to be the younger half of an apparent pair: the first of its cofacets to be added
+        // (the apparent cofacet) has it as its youngest face. The simplex is born, and the class dies when the apparent
+        // cofacet is added (with the cocycle that consists of the simplex alone). So its boundary is not evaluated,
+        // and no cocycle is allocated for it in the meantime. Only for ordinary (not image) persistence.
+        SimplexIndex        add_apparent(BirthInfo b, const SimplexData& sd = SimplexData());
+
+        // Clearing: the simplex si was added and a class died, so no cocycle ever contains it, and it contributes
+        // nothing to the coboundaries of its cofaces; it can be removed and left out of their boundaries.
+        void                clear(SimplexIndex si)                                      { simplices_.erase(si); }
+
+        const Field&        field() const                                               { return field_; }
+
         void                show_cocycles() const;
         CocycleIndex        begin()                                                     { return image_begin_; }
         CocycleIndex        end()                                                       { return cocycles_.end(); }
 
     private:
-        void                add_cocycle(CocycleCoefficientPair& z1, CocycleCoefficientPair& z2);
+        void                add_cocycle(CocycleCoefficientPair& z1, CocycleCoefficientPair& z2)   { add_column(z1, z2.first->zcolumn, z2.second); }
+        void                add_column(CocycleCoefficientPair& to, const ZColumn& from, FieldElement value);
+        // removes the simplex that has just been added (so the next one takes its order)
+        void                discard(SimplexIndex si)                                    { simplices_.erase(si); --next_order_; }
+
+        // births of the simplices waiting for their apparent cofacets, sorted by the order of the simplex
+        // (add_apparent() appends, since the orders only grow)
+        typedef             std::pair<unsigned, BirthInfo>                              ApparentBirth;
+        typedef             std::vector<ApparentBirth>                                  ApparentBirths;
+        struct              ApparentBirthOrderComparison
+        { bool              operator()(const ApparentBirth& b, unsigned o) const        { return b.first < o; } };
+        typedef             std::vector<CocycleCoefficientPair>                         Candidates;
 
     private:
         Simplices           simplices_;
         Cocycles            cocycles_;
         CocycleIndex        image_begin_;
         Field               field_;
+        unsigned            next_order_;
+        ApparentBirths      apparent_births_;
+        Candidates          candidates_, candidates_bulk_;                              // scratch space of add()
 };
         
 // Simplex representation
-template<class BirthInfo_, class SimplexData_, class Field_>
-struct CohomologyPersistence<BirthInfo_, SimplexData_, Field_>::SHead: public SimplexData
+template<class BirthInfo_, class SimplexData_, class Field_, class Storage_>
+struct CohomologyPersistence<BirthInfo_, SimplexData_, Field_, Storage_>::SHead: public SimplexData
 {
                     SHead(const SHead& other):
                         SimplexData(other), order(other.order)                  {}  // don't copy row since we can't
@@ -100,8 +146,8 @@ struct CohomologyPersistence<BirthInfo_, SimplexData_, Field_>::SHead: public Si
 
 // An entry in a cocycle column; it's also an element in an intrusive list, hence the list_base_hook<>
 typedef             bi::list_base_hook<bi::link_mode<bi::auto_unlink> >         auto_unlink_hook;
-template<class BirthInfo_, class SimplexData_, class Field_>
-struct CohomologyPersistence<BirthInfo_, SimplexData_, Field_>::SNode: public auto_unlink_hook
+template<class BirthInfo_, class SimplexData_, class Field_, class Storage_>
+struct CohomologyPersistence<BirthInfo_, SimplexData_, Field_, Storage_>::SNode: public auto_unlink_hook
 {
                     SNode(const SNode& other):
                         si(other.si), coefficient(other.coefficient), 
@@ -118,8 +164,8 @@ struct CohomologyPersistence<BirthInfo_, SimplexData_, Field_>::SNode: public au
     void            unlink()                    { auto_unlink_hook::unlink(); }
 };
 
-template<class BirthInfo_, class SimplexData_, class Field_>
-struct CohomologyPersistence<BirthInfo_, SimplexData_, Field_>::Cocycle
+template<class BirthInfo_, class SimplexData_, class Field_, class Storage_>
+struct CohomologyPersistence<BirthInfo_, SimplexData_, Field_, Storage_>::Cocycle
 {
                     Cocycle(const BirthInfo& b, unsigned o):
                         birth(b), order(o)                                      {}
@@ -1,4 +1,5 @@
 #include <boost/utility.hpp>
+#include <algorithm>
 #include <queue>
 #include <vector>
 #include <limits>
@@ -29,8 +30,8 @@ static Counter*  cCohomologyCocycleCount =              GetCounter("cohomology/c
 static Counter*  cCohomologyCandidatesCount =           GetCounter("cohomology/candidates");
 #endif // COUNTERS
 
-template<class BirthInfo, class SimplexData, class Field>
-class CohomologyPersistence<BirthInfo, SimplexData, Field>::CompareSNode
+template<class BirthInfo, class SimplexData, class Field, class Storage>
+class CohomologyPersistence<BirthInfo, SimplexData, Field, Storage>::CompareSNode
 {
     public:
         bool        operator()(const SNode& s1, const SNode& s2) const                  { return s1.si->order < s2.si->order; }
@@ -44,10 +45,10 @@ struct Alternator
 };
     
 
-template<class BirthInfo, class SimplexData, class Field>
+template<class BirthInfo, class SimplexData, class Field, class Storage>
 template<class BI>
-typename CohomologyPersistence<BirthInfo, SimplexData, Field>::IndexDeathCocycle
-CohomologyPersistence<BirthInfo, SimplexData, Field>::
+typename CohomologyPersistence<BirthInfo, SimplexData, Field, Storage>::IndexDeathCocycle
+CohomologyPersistence<BirthInfo, SimplexData, Field, Storage>::
 add(BI begin, BI end, BirthInfo birth, bool store, const SimplexData& sd, bool image)
 {
     // Set coefficient to be an iterator over (-1)^i
@@ -58,32 +59,40 @@ add(BI begin, BI end, BirthInfo birth, bool store, const SimplexData& sd, bool i
 }
 
 
-template<class BirthInfo, class SimplexData, class Field>
+template<class BirthInfo, class SimplexData, class Field, class Storage>
 template<class BI, class CI>
-typename CohomologyPersistence<BirthInfo, SimplexData, Field>::IndexDeathCocycle
-CohomologyPersistence<BirthInfo, SimplexData, Field>::
+typename CohomologyPersistence<BirthInfo, SimplexData, Field, Storage>::IndexDeathCocycle
+CohomologyPersistence<BirthInfo, SimplexData, Field, Storage>::
 add(CI coefficient_iter, BI begin, BI end, BirthInfo birth, bool store, const SimplexData& sd, bool image)
 {
     // Create simplex representation
-    simplices_.push_back(SHead(sd, simplices_.empty() ? 0 : (simplices_.back().order + 1)));
-    SimplexIndex    si = boost::prior(simplices_.end());
+    SimplexIndex    si = simplices_.insert(simplices_.end(), SHead(sd, next_order_++));
 
     // Find out if there are cocycles that evaluate to non-zero on the new simplex
-    typedef         std::list<CocycleCoefficientPair>           Candidates;
-    Candidates      candidates, candidates_bulk;
+    // (the buffers keep their memory from one call to the next)
+    Candidates&     candidates      = candidates_;
+    Candidates&     candidates_bulk = candidates_bulk_;
+    candidates.clear(); candidates_bulk.clear();
     rLog(rlCohomology, "Boundary");
 
+    SimplexIndex    youngest = simplices_.end();            // the only face that may wait for this simplex (see add_apparent())
+    FieldElement    youngest_coefficient = field_.zero();
     for (BI cur = begin; cur != end; ++cur)
     {
         FieldElement coefficient = field_.init(*coefficient_iter++);
         SimplexIndex cursi = *cur;
 
         rLog(rlCohomology, "  %d %d", cursi->order, coefficient);
+        if (youngest == simplices_.end() || youngest->order < cursi->order)
+        {
+            youngest = cursi;
+            youngest_coefficient = coefficient;
+        }
         BOOST_FOREACH(const SNode& zcur, std::make_pair(cursi->row.begin(), cursi->row.end()))
             candidates_bulk.push_back(std::make_pair(zcur.ci, field_.mul(coefficient, zcur.coefficient)));
     }
 
-    candidates_bulk.sort(make_first_comparison(make_indirect_comparison(std::less<Cocycle>())));
+    std::sort(candidates_bulk.begin(), candidates_bulk.end(), make_first_comparison(make_indirect_comparison(std::less<Cocycle>())));
     CountBy(cCohomologyCandidatesCount, candidates_bulk.size());
     
 #if LOGGING    
@@ -114,13 +123,41 @@ add(CI coefficient_iter, BI begin, BI end, BirthInfo birth, bool store, const Si
         }
     }
 
+    // Death of the (implicit) cocycle of the apparent face: it's the youngest one,
+    // since every other cocycle consists of simplices older than this simplex
+    typename ApparentBirths::iterator b = apparent_births_.end();
+    if (youngest != simplices_.end() && !apparent_births_.empty())
+    {
+        b = std::lower_bound(apparent_births_.begin(), apparent_births_.end(), youngest->order, ApparentBirthOrderComparison());
+        if (b != apparent_births_.end() && b->first != youngest->order)
+            b = apparent_births_.end();
+    }
+    if (b != apparent_births_.end())
+    {
+        rLog(rlCohomology,  "Apparent death: %d", youngest->order);
+
+        Death d = b->second;
+        apparent_births_.erase(b);                          // usually near the back: the cofacet follows soon after
+
+        boost::shared_ptr<ZColumn> p = boost::make_shared<ZColumn>();
+        p->push_back(SNode(youngest, field_.id(), cocycles_.end()));
+        for (typename Candidates::iterator cur = candidates.begin(); cur != candidates.end(); ++cur)
+        {
+            CountBy(cCohomologyElementCount, -cur->first->zcolumn.size());
+            add_column(*cur, *p, youngest_coefficient);
+            CountBy(cCohomologyElementCount, cur->first->zcolumn.size());
+        }
+
+        return boost::make_tuple(si, d, p);
+    }
+
     // Birth
     if (candidates.empty())
     {
         // rLog(rlCohomology, "  Birth occurred");
         if (!store)
         {
-            simplices_.pop_back();
+            discard(si);
             boost::shared_ptr<ZColumn> p = boost::make_shared<ZColumn>();
             return boost::make_tuple(simplices_.end(), Death(), p);
         }
@@ -200,10 +237,22 @@ add(CI coefficient_iter, BI begin, BI end, BirthInfo birth, bool store, const Si
 
     return boost::make_tuple(si, d, p);
 }
+
+template<class BirthInfo, class SimplexData, class Field, class Storage>
+typename CohomologyPersistence<BirthInfo, SimplexData, Field, Storage>::SimplexIndex
+CohomologyPersistence<BirthInfo, SimplexData, Field, Storage>::
+add_apparent(BirthInfo birth, const SimplexData& sd)
+{
+    SimplexIndex    si = simplices_.insert(simplices_.end(), SHead(sd, next_order_++));
+    apparent_births_.push_back(ApparentBirth(si->order, birth));
+    rLog(rlCohomology,  "Apparent birth: %d", si->order);
+
+    return si;
+}
         
-template<class BirthInfo, class SimplexData, class Field>
+template<class BirthInfo, class SimplexData, class Field, class Storage>
 void
-CohomologyPersistence<BirthInfo, SimplexData, Field>::
+CohomologyPersistence<BirthInfo, SimplexData, Field, Storage>::
 show_cocycles() const
 {
     std::cout << "Cocycles: " << cocycles_.size() << std::endl;
@@ -216,22 +265,22 @@ show_cocycles() const
     }
 }
 
-template<class BirthInfo, class SimplexData, class Field>
+template<class BirthInfo, class SimplexData, class Field, class Storage>
 void
-CohomologyPersistence<BirthInfo, SimplexData, Field>::
-add_cocycle(CocycleCoefficientPair& to, CocycleCoefficientPair& from)
+CohomologyPersistence<BirthInfo, SimplexData, Field, Storage>::
+add_column(CocycleCoefficientPair& to, const ZColumn& from, FieldElement value)
 {
-    rLog(rlCohomology,  "Adding cocycle %d to %d", from.first->order, to.first->order);
+    rLog(rlCohomology,  "Adding cocycle to %d", to.first->order);
 
-    FieldElement    multiplier = field_.neg(field_.div(to.second, from.second));
+    FieldElement    multiplier = field_.neg(field_.div(to.second, value));
     CocycleIndex    ci = to.first;
     CompareSNode    cmp;
 
     // Insert at the end optimization
-    if (cmp(to.first->zcolumn.back(), from.first->zcolumn.front()) && 
-        to.first->zcolumn.capacity() >= (to.first->zcolumn.size() + from.first->zcolumn.size()))
+    if (cmp(to.first->zcolumn.back(), from.front()) && 
+        to.first->zcolumn.capacity() >= (to.first->zcolumn.size() + from.size()))
     {
-        BOOST_FOREACH(const SNode& fs, from.first->zcolumn)
+        BOOST_FOREACH(const SNode& fs, from)
         {
             to.first->zcolumn.push_back(SNode(fs.si, field_.mul(multiplier, fs.coefficient), ci));
             fs.si->row.push_back(to.first->zcolumn.back());
@@ -243,8 +292,8 @@ add_cocycle(CocycleCoefficientPair& to, CocycleCoefficientPair& from)
 
     ZColumn         nw;
     typename ZColumn::iterator tcur = to.first->zcolumn.begin();
-    typename ZColumn::iterator fcur = from.first->zcolumn.begin();
-    while (tcur != to.first->zcolumn.end() && fcur != from.first->zcolumn.end())
+    typename ZColumn::const_iterator fcur = from.begin();
+    while (tcur != to.first->zcolumn.end() && fcur != from.end())
     {
         rLog(rlCohomology, "  %d %d", tcur->si->order, fcur->si->order);
         Count(cCohomologyAddComparison);
@@ -274,7 +323,7 @@ add_cocycle(CocycleCoefficientPair& to, CocycleCoefficientPair& from)
         Count(cCohomologyAddBasic);
         nw.push_back(SNode(*tcur));
     }
-    for (; fcur != from.first->zcolumn.end(); ++fcur)
+    for (; fcur != from.end(); ++fcur)
     {
         rLog(rlCohomology, "  %d", fcur->si->order);
         Count(cCohomologyAddBasic);
@@ -0,0 +1,289 @@
+#ifndef __EDGE_SWEEP_H__
+#define __EDGE_SWEEP_H__
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/utility.hpp>
+
+#include <topology/simplex.h>           // for Dimension
+
+
+/**
+ * Class: EdgeSweep
+ * Enumerates the cliques of a NeighborGraph in the filtration order of the Rips complex: by value (the length
+ * of the longest edge), and by dimension among the cliques with the same value, so that every clique comes after
+ * all of its faces. Used by Rips::generate_sorted().
+ *
+ * The vertices come first. Then the edges are swept in the order of their lengths (ties broken by their vertices),
+ * and every group of edges of the same length is processed one dimension at a time: first the edges themselves,
+ * then, for each d = 2, ..., k, the d-dimensional cliques whose longest edge (the last one in the sweep) is in the
+ * group. A clique with the longest edge (u,v) consists of u, v, and vertices w adjacent to both of them by edges
+ * that come earlier in the sweep; every edge stores its rank in the sweep, so these are found by intersecting the
+ * sorted neighbor lists, as in SortedListEngine. The cliques with the same longest edge come in the lexicographic
+ * order of their remaining (sorted) vertices. No clique is buffered: each one is passed to the functor as soon
+ * as it is found.
+ *
+ * Parameters:
+ *   Graph -        NeighborGraph
+ *   View -         SimplexView passed to the functor (with its vertices sorted)
+ */
+template<class Graph, class View>
+class EdgeSweep
+{
+    public:
+        typedef             typename Graph::IndexType                       IndexType;
+        typedef             typename Graph::DistanceType                    DistanceType;
+        typedef             typename Graph::NeighborIterator                NeighborIterator;
+        typedef             typename View::Vertex                           Vertex;
+
+        // Sorts the edges and ranks every entry of the neighbor lists
+                            EdgeSweep(const Graph& graph);
+
+        // Calls f(View, DistanceType) on every clique with at most k+1 vertices, in the filtration order
+        template<class Functor>
+        void                generate(Dimension k, const Functor& f);
+
+        // Whether the clique that generate() has just passed to the functor is the younger half of an apparent pair:
+        // the youngest facet of its oldest coface with one more vertex (see StreamedRipsFiltration::apparent())
+        bool                apparent() const;
+
+        // Rank in the sweep of the edge at the position n of a neighbor list
+        size_t              rank(NeighborIterator n) const                  { return ranks_[graph_.position(n)]; }
+
+    private:
+        struct              Edge
+        {
+                            Edge(DistanceType l, IndexType uu, IndexType vv):
+                                length(l), u(uu), v(vv)                     {}
+
+            bool            operator<(const Edge& other) const
+            {
+                if (length == other.length)
+                    return u < other.u || (u == other.u && v < other.v);
+                return length < other.length;
+            }
+
+            DistanceType    length;
+            IndexType       u, v;
+        };
+
+        // Reports every clique with target vertices that extends the first size vertices of current_
+        // by vertices in [bg, end) connected to them (and to each other) by edges ranked below r
+        template<class Functor>
+        void                expand(size_t size, size_t target, const IndexType* bg, const IndexType* end,
+                                   size_t r, DistanceType value, const Functor& f);
+
+        template<class Functor>
+        void                report(size_t size, DistanceType value, const Functor& f);
+
+        const Graph&                                graph_;
+        std::vector<Edge>                           edges_;             // in the order of the sweep
+        size_t                                      k_, size_, r_, n_;  // state of the sweep: the clique being reported,
+                                                                        // the current edge, and the number of its candidates
+        std::vector<size_t>                         ranks_;             // rank of the edge at every position of the graph
+        std::vector<Vertex>                         current_;
+        std::vector<Vertex>                         sorted_;            // current_ sorted for reporting
+        std::vector< std::vector<IndexType> >       levels_;            // candidates at every depth of the recursion
+};
+
+
+template<class Graph, class View>
+EdgeSweep<Graph, View>::
+EdgeSweep(const Graph& graph): graph_(graph)
+{
+    edges_.reserve(graph_.edges());
+    for (IndexType u = 0; u < graph_.size(); ++u)
+    {
+        NeighborIterator upper = graph_.upper_neighbors_begin(u);
+        typename Graph::LengthIterator length = graph_.lengths_at(upper);
+        for (NeighborIterator v = upper; v != graph_.neighbors_end(u); ++v, ++length)
+            edges_.push_back(Edge(*length, u, *v));
+    }
+    std::sort(edges_.begin(), edges_.end());
+
+    ranks_.resize(2*graph_.edges());
+    for (size_t r = 0; r < edges_.size(); ++r)
+    {
+        const Edge& e = edges_[r];
+        ranks_[graph_.position(std::lower_bound(graph_.neighbors_begin(e.u), graph_.neighbors_end(e.u), e.v))] = r;
+        ranks_[graph_.position(std::lower_bound(graph_.neighbors_begin(e.v), graph_.neighbors_end(e.v), e.u))] = r;
+    }
+}
+
+template<class Graph, class View>
+template<class Functor>
+void
+EdgeSweep<Graph, View>::
+generate(Dimension k, const Functor& f)
+{
+    // the candidates for the cofaces of an edge are a subset of the neighbors of its first vertex
+    size_t max_degree = 0;
+    for (IndexType v = 0; v < graph_.size(); ++v)
+        max_degree = std::max(max_degree, graph_.degree(v));
+    current_.resize(k + 1);
+    sorted_.resize(k + 1);
+    levels_.resize(k + 1, std::vector<IndexType>(max_degree));
+    k_ = k; n_ = 0;
+
+    size_ = 1;
+    for (IndexType v = 0; v < graph_.size(); ++v)
+    {
+        current_[0] = v;
+        f(View(&current_[0], &current_[0] + 1), 0);
+    }
+    if (k < 1)
+        return;
+
+    for (size_t group = 0; group < edges_.size(); )
+    {
+        DistanceType value      = edges_[group].length;
+        size_t       group_end  = group;
+        while (group_end < edges_.size() && edges_[group_end].length == value)
+            ++group_end;
+
+        size_ = 2;
+        for (r_ = group; r_ < group_end; ++r_)
+        {
+            current_[0] = edges_[r_].u; current_[1] = edges_[r_].v;
+            f(View(&current_[0], &current_[0] + 2), value);
+        }
+
+        for (Dimension d = 2; d <= k; ++d)
+            for (size_t r = group; r < group_end; ++r)
+            {
+                const Edge& e = edges_[r];
+
+                // common neighbors of u and v, connected to both by edges that come before e
+                IndexType*          candidates = &levels_[0][0];
+                size_t              n = 0;
+                NeighborIterator    a = graph_.neighbors_begin(e.u), a_end = graph_.neighbors_end(e.u),
+                                    b = graph_.neighbors_begin(e.v), b_end = graph_.neighbors_end(e.v);
+                while (a != a_end && b != b_end)
+                {
+                    if      (*a < *b)   ++a;
+                    else if (*b < *a)   ++b;
+                    else
+                    {
+                        if (rank(a) < r && rank(b) < r)
+                            candidates[n++] = *a;
+                        ++a; ++b;
+                    }
+                }
+
+                current_[0] = e.u; current_[1] = e.v;
+                r_ = r; n_ = n;
+                expand(2, d + 1, candidates, candidates + n, r, value, f);
+            }
+
+        group = group_end;
+    }
+}
+
+template<class Graph, class View>
+template<class Functor>
+void
+EdgeSweep<Graph, View>::
+expand(size_t size, size_t target, const IndexType* bg, const IndexType* end, size_t r, DistanceType value, const Functor& f)
+{
+    if (size == target)
+    {
+        report(size, value, f);
+        return;
+    }
+    if (static_cast<size_t>(end - bg) < target - size)        // not enough candidates left
+        return;
+
+    // candidates are sorted, so the ones following cur that are adjacent to it come out sorted as well
+    IndexType* new_candidates = &levels_[size][0];
+    for (const IndexType* cur = bg; cur != end; ++cur)
+    {
+        size_t              n = 0;
+        const IndexType*    a = boost::next(cur);
+        NeighborIterator    b = graph_.upper_neighbors_begin(*cur), b_end = graph_.neighbors_end(*cur);
+        while (a != end && b != b_end)
+        {
+            if      (*a < *b)   ++a;
+            else if (*b < *a)   ++b;
+            else
+            {
+                if (rank(b) < r)
+                    new_candidates[n++] = *a;
+                ++a; ++b;
+            }
+        }
+
+        current_[size] = *cur;
+        expand(size + 1, target, new_candidates, new_candidates + n, r, value, f);
+    }
+}
+
+template<class Graph, class View>
+template<class Functor>
+void
+EdgeSweep<Graph, View>::
+report(size_t size, DistanceType value, const Functor& f)
+{
+    std::copy(current_.begin(), current_.begin() + size, sorted_.begin());
+    std::sort(sorted_.begin(), sorted_.begin() + size);
+    size_ = size;
+    f(View(&sorted_[0], &sorted_[0] + size), value);
+}
+
+template<class Graph, class View>
+bool
+EdgeSweep<Graph, View>::
+apparent() const
+{
+    if (size_ > k_)                             // no cofaces
+        return false;
+
+    // a vertex comes after the vertices with smaller indices, and its oldest coface is its edge of the lowest rank
+    if (size_ == 1)
+    {
+        IndexType        v = current_[0];
+        NeighborIterator oldest = graph_.neighbors_begin(v);
+        for (NeighborIterator cur = oldest; cur != graph_.neighbors_end(v); ++cur)
+            if (rank(cur) < rank(oldest))
+                oldest = cur;
+        return oldest != graph_.neighbors_end(v) && *oldest < v;
+    }
+
+    // The cofaces of a clique that come first share its longest edge (u,v) = current_[0,1] (if there are any),
+    // and add the smallest common neighbor w connected to all of its vertices by edges that come earlier;
+    // the clique is the youngest facet of such a coface if w precedes its other vertices current_[2,...].
+    if (size_ == 2)                             // the candidates have not been computed yet
+    {
+        NeighborIterator    a = graph_.neighbors_begin(current_[0]), a_end = graph_.neighbors_end(current_[0]),
+                            b = graph_.neighbors_begin(current_[1]), b_end = graph_.neighbors_end(current_[1]);
+        while (a != a_end && b != b_end)
+        {
+            if      (*a < *b)   ++a;
+            else if (*b < *a)   ++b;
+            else
+            {
+                if (rank(a) < r_ && rank(b) < r_)
+                    return true;
+                ++a; ++b;
+            }
+        }
+        return false;
+    }
+
+    const std::vector<IndexType>& candidates = levels_[0];
+    for (size_t i = 0; i < n_ && candidates[i] < current_[2]; ++i)
+    {
+        IndexType   w = candidates[i];
+        bool        common = true;
+        for (size_t j = 2; j < size_ && common; ++j)
+        {
+            NeighborIterator n = std::lower_bound(graph_.neighbors_begin(current_[j]), graph_.neighbors_end(current_[j]), w);
+            common = n != graph_.neighbors_end(current_[j]) && *n == w && rank(n) < r_;
+        }
+        if (common)
+            return true;
+    }
+    return false;
+}
+
+#endif // __EDGE_SWEEP_H__
@@ -3,42 +3,137 @@
 
 #include <vector>
 
+#include <boost/cstdint.hpp>
+
+#include "utilities/log.h"
+
+/**
+ * Class: ZpField
+ * Integers modulo the prime p, given at runtime (p < 2^16, prime_limit). The elements are kept in [0, p), so sums and negations
+ * need at most one conditional subtraction, and for p < 2^15 (barrett_limit) products are reduced with Barrett's method
+ * (a multiplication and a shift by the precomputed floor(2^32/p) instead of a division); the larger primes fall back
+ * to the division. The inverses are tabulated in the constructor.
+ *
+ * See StaticZpField for a compile-time p, and with_zp_field() to choose between the two.
+ */
 class ZpField
 {
     public:
         typedef     int                                             Element;
 
+        // The primes must be below prime_limit (so that the products fit into 32 bits); the ones below barrett_limit
+        // are reduced with Barrett's method, and the rest with the division
+        static const Element prime_limit   = 1 << 16;
+        static const Element barrett_limit = 1 << 15;
+
                     ZpField(Element p = 2);
 
+        Element     prime() const                                   { return p_; }
+
         Element     id()  const                                     { return 1; }
         Element     zero()  const                                   { return 0; }
-        Element     init(int a) const                               { return (a % p_ + p_) % p_; }
+        Element     init(int a) const                               { a %= p_; return a < 0 ? a + p_ : a; }
 
-        Element     neg(Element a) const                            { return p_ - a; }
-        Element     add(Element a, Element b) const                 { return (a+b) % p_; }
+        Element     neg(Element a) const                            { return a ? p_ - a : 0; }
+        Element     add(Element a, Element b) const                 { a += b; return a >= p_ ? a - p_ : a; }
 
         Element     inv(Element a) const                            { return inverses_[a]; }
-        Element     mul(Element a, Element b) const                 { return (a*b) % p_; }
+        Element     mul(Element a, Element b) const
+        {
+            boost::uint32_t x = static_cast<boost::uint32_t>(a) * static_cast<boost::uint32_t>(b);
+            return p_ < barrett_limit ? reduce(x) : static_cast<Element>(x % p_);
+        }
         Element     div(Element a, Element b) const                 { return mul(a, inv(b)); }
 
-        bool        is_zero(Element a) const                        { return (a % p_) == 0; }
+        bool        is_zero(Element a) const                        { return a == 0; }
 
     private:
+        // x mod p for x < p^2 (and p < barrett_limit): the quotient estimate is short by at most one
+        Element     reduce(boost::uint32_t x) const
+        {
+            boost::uint32_t q = static_cast<boost::uint32_t>((x * barrett_) >> 32);
+            boost::uint32_t r = x - q*p_;
+            return r >= static_cast<boost::uint32_t>(p_) ? r - p_ : r;
+        }
+
         Element                 p_;
+        boost::uint64_t         barrett_;
         std::vector<Element>    inverses_;
 };
 
+inline
 ZpField::
 ZpField(Element p):
-    p_(p), inverses_(p_)
+    p_(p), barrett_((boost::uint64_t(1) << 32) / p), inverses_(p_)
+{
+    AssertMsg(p_ >= 2 && p_ < prime_limit, "ZpField needs a (small) prime");
+
+    // p = (p/i)*i + p%i, so 1/i = -(p/i) * 1/(p%i)
+    inverses_[1] = 1;
+    for (Element i = 2; i < p_; ++i)
+        inverses_[i] = neg(mul(p_ / i, inverses_[p_ % i]));
+}
+
+
+/**
+ * Class: StaticZpField
+ * Same as ZpField, but for the prime p_ fixed at compile time: the compiler turns every reduction modulo the
+ * constant into a multiplication and a shift on its own, and the inverses live in the object.
+ */
+template<int p_>
+class StaticZpField
+{
+    public:
+        typedef     int                                             Element;
+
+                    StaticZpField()
+        {
+            inverses_[0] = 0;
+            inverses_[1] = 1;
+            for (Element i = 2; i < p_; ++i)
+                inverses_[i] = neg(mul(p_ / i, inverses_[p_ % i]));
+        }
+
+        Element     prime() const                                   { return p_; }
+
+        Element     id()  const                                     { return 1; }
+        Element     zero()  const                                   { return 0; }
+        Element     init(int a) const                               { a %= p_; return a < 0 ? a + p_ : a; }
+
+        Element     neg(Element a) const                            { return a ? p_ - a : 0; }
+        Element     add(Element a, Element b) const                 { a += b; return a >= p_ ? a - p_ : a; }
+
+        Element     inv(Element a) const                            { return inverses_[a]; }
+        Element     mul(Element a, Element b) const                 { return static_cast<boost::uint32_t>(a*b) % p_; }
+        Element     div(Element a, Element b) const                 { return mul(a, inv(b)); }
+
+        bool        is_zero(Element a) const                        { return a == 0; }
+
+    private:
+        Element     inverses_[p_];
+};
+
+
+/**
+ * Function: with_zp_field
+ * Calls f(field) with StaticZpField<p> if p is one of the primes that are used the most (2, 3, 5, 7, 11, 13, 47),
+ * and with ZpField(p) otherwise; f must accept either field (e.g., through a template operator()), and
+ * the code instantiated with it is compiled once per prime.
+ */
+template<class Functor>
+void        with_zp_field(ZpField::Element p, const Functor& f)
 {
-    for (Element i = 1; i < p_; ++i)
-        for (Element j = 1; j < p_; ++j)
-            if (mul(i,j) == 1)
-            {
-                inverses_[i] = j;
-                break;
-            }
+    switch (p)
+    {
+        case 2:     f(StaticZpField<2>());      break;
+        case 3:     f(StaticZpField<3>());      break;
+        case 5:     f(StaticZpField<5>());      break;
+        case 7:     f(StaticZpField<7>());      break;
+        case 11:    f(StaticZpField<11>());     break;
+        case 13:    f(StaticZpField<13>());     break;
+        case 47:    f(StaticZpField<47>());     break;
+        default:    f(ZpField(p));              break;
+    }
 }
 
 #if 0                   // unused example; commented out to get rid of the artificial dependence on GMP
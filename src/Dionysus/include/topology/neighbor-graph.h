@@ -0,0 +1,222 @@
+#ifndef __NEIGHBOR_GRAPH_H__
+#define __NEIGHBOR_GRAPH_H__
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include <utilities/parallel.h>
+
+
+/**
+ * Class: NeighborGraph
+ * Stores the edges of a Rips complex (pairs of points within the given distance of each other)
+ * in compressed sparse row format: neighbors of vertex v occupy positions [offset(v), offset(v+1))
+ * of a single array, sorted by index, and the lengths of the corresponding edges are stored in
+ * a parallel array. Vertices are the indices [0, size()).
+ *
+ * Parameters:
+ *   Index_ -       vertex type (IndexType of the distances)
+ *   Distance_ -    type of the edge lengths (DistanceType of the distances)
+ */
+template<class Index_ = unsigned, class Distance_ = double>
+class NeighborGraph
+{
+    public:
+        typedef             Index_                                          IndexType;
+        typedef             Distance_                                       DistanceType;
+        typedef             const IndexType*                                NeighborIterator;
+        typedef             const DistanceType*                             LengthIterator;
+
+        typedef             std::pair<IndexType, DistanceType>              Neighbor;
+        typedef             std::vector<Neighbor>                           NeighborVector;
+
+                            NeighborGraph(): offsets_(1, 0)                 {}
+
+        // Evaluates every distance exactly once (rows are split across threads; see parallel_for())
+        template<class Distances>
+                            NeighborGraph(const Distances& distances, DistanceType max, unsigned threads = 1);
+
+        // Evaluates only the distances to the candidates: candidates(a, max, out) fills the vector out with (at least) all
+        // the b > a within max of a, in any order, e.g., from a spatial index (see KDTree); the graph is the same as above.
+        // (threads has no default, so that NeighborGraph(distances, max, threads) is never taken for this one.)
+        template<class Distances, class Candidates>
+                            NeighborGraph(const Distances& distances, const Candidates& candidates, DistanceType max, unsigned threads);
+
+        // Builds the graph out of the lists of neighbors of every vertex; the lists need not be sorted,
+        // but they must be symmetric (u appears among the neighbors of v iff v appears among the neighbors of u)
+                            NeighborGraph(const std::vector<NeighborVector>& neighbors)  { assign(neighbors); }
+
+        size_t              size() const                                    { return offsets_.size() - 1; }
+        size_t              edges() const                                   { return neighbors_.size()/2; }
+        size_t              degree(IndexType v) const                       { return offsets_[v+1] - offsets_[v]; }
+
+        NeighborIterator    neighbors_begin(IndexType v) const              { return neighbors_.empty() ? 0 : &neighbors_[0] + offsets_[v]; }
+        NeighborIterator    neighbors_end(IndexType v) const                { return neighbors_.empty() ? 0 : &neighbors_[0] + offsets_[v+1]; }
+        LengthIterator      lengths_begin(IndexType v) const                { return lengths_.empty()   ? 0 : &lengths_[0]   + offsets_[v]; }
+
+        // Neighbors of v with index greater than v
+        NeighborIterator    upper_neighbors_begin(IndexType v) const        { return std::upper_bound(neighbors_begin(v), neighbors_end(v), v); }
+
+        // Length of the edge to the neighbor at position n (in any of the lists)
+        LengthIterator      lengths_at(NeighborIterator n) const            { return lengths_.empty() ? 0 : &lengths_[0] + (n - &neighbors_[0]); }
+        // Index of the position n in the single array of all the lists (so that per-entry data can be kept alongside)
+        size_t              position(NeighborIterator n) const              { return neighbors_.empty() ? 0 : n - &neighbors_[0]; }
+
+        bool                adjacent(IndexType u, IndexType v) const        { return std::binary_search(neighbors_begin(u), neighbors_end(u), v); }
+        // Length of the edge (u,v), which must be in the graph
+        DistanceType        length(IndexType u, IndexType v) const          { return *lengths_at(std::lower_bound(neighbors_begin(u), neighbors_end(u), v)); }
+
+    private:
+        void                assign(const std::vector<NeighborVector>& neighbors);
+        // Builds the graph out of the rows of the neighbors b > a of every a (sorted by b)
+        void                symmetrize(std::vector<NeighborVector>& rows);
+
+        template<class Distances>
+        class               RowTask;
+        template<class Distances, class Candidates>
+        class               CandidateRowTask;
+
+    private:
+        std::vector<size_t>         offsets_;
+        std::vector<IndexType>      neighbors_;
+        std::vector<DistanceType>   lengths_;
+};
+
+// Fills row a with the neighbors b > a
+template<class I, class D>
+template<class Distances>
+class NeighborGraph<I,D>::RowTask
+{
+    public:
+                            RowTask(const Distances& distances, DistanceType max, std::vector<NeighborVector>& rows):
+                                distances_(distances), max_(max), rows_(rows)           {}
+
+        void                operator()(size_t a, unsigned) const
+        {
+            for (IndexType b = a + 1; b < rows_.size(); ++b)
+            {
+                DistanceType d = distances_(a, b);
+                if (d <= max_)
+                    rows_[a].push_back(Neighbor(b, d));
+            }
+        }
+
+    private:
+        const Distances&                distances_;
+        DistanceType                    max_;
+        std::vector<NeighborVector>&    rows_;
+};
+
+template<class I, class D>
+template<class Distances>
+NeighborGraph<I,D>::
+NeighborGraph(const Distances& distances, DistanceType max, unsigned threads)
+{
+    std::vector<NeighborVector> rows(distances.size());
+    RowTask<Distances> task(distances, max, rows);
+    parallel_for(rows.size(), task, threads);
+    symmetrize(rows);
+}
+
+// Fills row a with the candidates b > a within max
+template<class I, class D>
+template<class Distances, class Candidates>
+class NeighborGraph<I,D>::CandidateRowTask
+{
+    public:
+                            CandidateRowTask(const Distances& distances, const Candidates& candidates, DistanceType max,
+                                             std::vector<NeighborVector>& rows):
+                                distances_(distances), candidates_(candidates), max_(max), rows_(rows)  {}
+
+        void                operator()(size_t a, unsigned) const
+        {
+            std::vector<IndexType>  candidates;
+            candidates_(a, max_, candidates);
+            std::sort(candidates.begin(), candidates.end());
+            for (size_t i = 0; i < candidates.size(); ++i)
+            {
+                IndexType b = candidates[i];
+                if (b <= a)
+                    continue;
+                DistanceType d = distances_(a, b);
+                if (d <= max_)
+                    rows_[a].push_back(Neighbor(b, d));
+            }
+        }
+
+    private:
+        const Distances&                distances_;
+        const Candidates&               candidates_;
+        DistanceType                    max_;
+        std::vector<NeighborVector>&    rows_;
+};
+
+template<class I, class D>
+template<class Distances, class Candidates>
+NeighborGraph<I,D>::
+NeighborGraph(const Distances& distances, const Candidates& candidates, DistanceType max, unsigned threads)
+{
+    std::vector<NeighborVector> rows(distances.size());
+    CandidateRowTask<Distances, Candidates> task(distances, candidates, max, rows);
+    parallel_for(rows.size(), task, threads);
+    symmetrize(rows);
+}
+
+template<class I, class D>
+void
+NeighborGraph<I,D>::
+symmetrize(std::vector<NeighborVector>& rows)
+{
+    offsets_.assign(rows.size() + 1, 0);
+    for (IndexType a = 0; a < rows.size(); ++a)
+    {
+        offsets_[a+1] += rows[a].size();
+        for (typename NeighborVector::const_iterator cur = rows[a].begin(); cur != rows[a].end(); ++cur)
+            ++offsets_[cur->first + 1];
+    }
+    for (IndexType a = 0; a < rows.size(); ++a)
+        offsets_[a+1] += offsets_[a];
+
+    // Symmetrize; rows are processed in order, so every list comes out sorted
+    neighbors_.resize(offsets_.back());
+    lengths_.resize(offsets_.back());
+    std::vector<size_t> fill(offsets_.begin(), offsets_.end() - 1);
+    for (IndexType a = 0; a < rows.size(); ++a)
+    {
+        for (typename NeighborVector::const_iterator cur = rows[a].begin(); cur != rows[a].end(); ++cur)
+        {
+            size_t i = fill[cur->first]++, j = fill[a]++;
+            neighbors_[i] = a;              lengths_[i] = cur->second;
+            neighbors_[j] = cur->first;     lengths_[j] = cur->second;
+        }
+        NeighborVector().swap(rows[a]);
+    }
+}
+
+template<class I, class D>
+void
+NeighborGraph<I,D>::
+assign(const std::vector<NeighborVector>& neighbors)
+{
+    offsets_.resize(neighbors.size() + 1);
+    offsets_[0] = 0;
+    for (IndexType v = 0; v < neighbors.size(); ++v)
+        offsets_[v+1] = offsets_[v] + neighbors[v].size();
+
+    neighbors_.resize(offsets_.back());
+    lengths_.resize(offsets_.back());
+    NeighborVector sorted;
+    for (IndexType v = 0; v < neighbors.size(); ++v)
+    {
+        sorted = neighbors[v];
+        std::sort(sorted.begin(), sorted.end());
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            neighbors_[offsets_[v] + i] = sorted[i].first;
+            lengths_[offsets_[v] + i]   = sorted[i].second;
+        }
+    }
+}
+
+#endif // __NEIGHBOR_GRAPH_H__
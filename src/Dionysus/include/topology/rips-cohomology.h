@@ -0,0 +1,153 @@
+#ifndef __RIPS_COHOMOLOGY_H__
+#define __RIPS_COHOMOLOGY_H__
+
+#include <vector>
+
+#include "streamed-rips.h"
+#include "simplex-key.h"
+#include "cohomology-persistence.h"
+
+#include <boost/tuple/tuple.hpp>
+
+
+/**
+ * Class: RipsCohomology
+ * Computes the persistent cohomology of a StreamedRipsFiltration with CohomologyPersistence, without
+ * materializing the top-dimensional simplices. The simplices are streamed in the filtration order; the top-dimensional
+ * ones (the vast majority) are added with store = false and forgotten right away, and the facets of every
+ * simplex are found by their keys in a SimplexKeyMap. So the pairs and the cocycles are exactly the ones
+ * CohomologyPersistence computes for the same filtration (e.g., the one of Rips::generate_sorted()), but
+ * the memory holds only the graph, the lower-dimensional simplices, and the cocycles.
+ * (The lower-dimensional simplices are stored, not enumerated as cofacets on demand: the cocycles refer to them.)
+ *
+ * The entries of the cocycles refer to their simplices by key (SNode::si->key; see SimplexKeys).
+ *
+ * With apparent_pairs (the default), the younger halves of the apparent pairs (see StreamedRipsFiltration::apparent())
+ * are added with CohomologyPersistence::add_apparent(), and the simplices that kill a class are cleared right away
+ * (see CohomologyPersistence::clear()) and left out of the boundaries of their cofacets. The pairs and the cocycles
+ * are the same either way.
+ *
+ * Storage_ is passed to CohomologyPersistence (see PooledStorage).
+ */
+template<class Distances_, class Field_ = ZpField, class Storage_ = PooledStorage>
+class RipsCohomology
+{
+    public:
+        typedef             StreamedRipsFiltration<Distances_>                  Filtration;
+        typedef             typename Filtration::IndexType                      IndexType;
+        typedef             typename Filtration::DistanceType                   DistanceType;
+        typedef             typename Filtration::Key                            Key;
+        typedef             typename Filtration::View                           View;
+        typedef             Field_                                              Field;
+
+        // Data stored with every simplex in CohomologyPersistence
+        struct              KeyData
+        {
+                            KeyData(Key k = 0): key(k)                          {}
+            Key             key;
+        };
+
+        typedef             boost::tuple<Dimension, DistanceType>               BirthInfo;
+        typedef             CohomologyPersistence<BirthInfo, KeyData, Field, Storage_>  Persistence;
+        typedef             typename Persistence::SimplexIndex                  SimplexIndex;
+        typedef             typename Persistence::ZColumn                       ZColumn;
+        typedef             typename Persistence::CocycleIndex                  CocycleIndex;
+
+                            RipsCohomology(const Filtration& filtration, const Field& field = Field(), bool apparent_pairs = true):
+                                filtration_(filtration), persistence_(field), apparent_pairs_(apparent_pairs)   {}
+
+        // Adds all the simplices of the filtration; calls f(Dimension, DistanceType birth, DistanceType death, const ZColumn&)
+        // for every class that dies, with the cocycle that represents it just before its death
+        // (birth == death for the pairs of zero persistence)
+        template<class Functor>
+        void                compute(const Functor& f);
+
+        // Cocycles that remain alive after compute()
+        CocycleIndex        begin()                                             { return persistence_.begin(); }
+        CocycleIndex        end()                                               { return persistence_.end(); }
+
+        const Filtration&   filtration() const                                  { return filtration_; }
+        Persistence&        persistence()                                       { return persistence_; }
+
+    private:
+        template<class Functor>
+        class               AddSimplex;
+
+    private:
+        const Filtration&   filtration_;
+        Persistence         persistence_;
+        bool                apparent_pairs_;
+};
+
+template<class D, class F, class S>
+template<class Functor>
+class RipsCohomology<D,F,S>::AddSimplex
+{
+    public:
+                            AddSimplex(RipsCohomology& cohomology, const Functor& f):
+                                filtration_(cohomology.filtration_), persistence_(cohomology.persistence_), f_(f),
+                                apparent_pairs_(cohomology.apparent_pairs_), complex_(filtration_.skeleton()),
+                                facets_(filtration_.skeleton() + 1), boundary_(filtration_.skeleton() + 1),
+                                coefficients_(filtration_.skeleton() + 1)                                       {}
+
+        // The state is modified through the references, since the filtration takes the functor by const reference
+        void                operator()(const View& v, DistanceType value) const
+        {
+            Dimension       d = v.dimension();
+            Key             k = filtration_.key(v.begin(), v.end());
+            bool            store = d < filtration_.skeleton();
+            if (store && apparent_pairs_ && filtration_.apparent())
+            {
+                complex_.insert(d, k, persistence_.add_apparent(BirthInfo(d, value), KeyData(k)));
+                return;
+            }
+
+            // the cleared facets are not in the complex
+            size_t          n = 0;
+            if (d > 0)
+            {
+                filtration_.facets(v.begin(), v.end(), facets_.begin());
+                for (Dimension i = 0; i <= d; ++i)
+                {
+                    const SimplexIndex* facet = complex_.find(d - 1, facets_[i]);
+                    if (!facet) continue;
+                    boundary_[n]        = *facet;
+                    coefficients_[n++]  = (i % 2) ? -1 : 1;
+                }
+            }
+
+            SimplexIndex    si;
+            typename Persistence::Death         death;
+            typename Persistence::CocyclePtr    cocycle;
+            boost::tie(si, death, cocycle) = persistence_.add(coefficients_.begin(), boundary_.begin(), boundary_.begin() + n,
+                                                              BirthInfo(d, value), store, KeyData(k));
+            if (death && (!store || apparent_pairs_))
+                persistence_.clear(si);
+            else if (store)
+                complex_.insert(d, k, si);
+            if (death)
+                f_(death->template get<0>(), death->template get<1>(), value, *cocycle);
+        }
+
+    private:
+        const Filtration&                       filtration_;
+        Persistence&                            persistence_;
+        const Functor&                          f_;
+        bool                                    apparent_pairs_;
+        mutable SimplexKeyMap<SimplexIndex>     complex_;
+        mutable std::vector<Key>                facets_;
+        mutable std::vector<SimplexIndex>       boundary_;
+        mutable std::vector<int>                coefficients_;
+};
+
+template<class D, class F, class S>
+template<class Functor>
+void
+RipsCohomology<D,F,S>::
+compute(const Functor& f)
+{
+    AddSimplex<Functor> add(*this, f);
+    filtration_.generate(add);
+}
+
+#endif // __RIPS_COHOMOLOGY_H__
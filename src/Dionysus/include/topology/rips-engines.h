@@ -0,0 +1,229 @@
+#ifndef __RIPS_ENGINES_H__
+#define __RIPS_ENGINES_H__
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <topology/simplex.h>           // for Dimension
+
+
+/**
+ * Engines: clique expansion policies for Rips
+ *
+ * An engine determines how Rips::generate(k, graph, f) computes the candidates of the next level of
+ * the recursion (the vertices following the newly added vertex that are adjacent to it). Engine::Expander<Graph, View>
+ * is constructed from the graph and provides generate(k, f, values) that calls f on every clique (as a SimplexView) with
+ * at most k+1 vertices, together with its diameter (the length of its longest edge) if values is true (otherwise the
+ * engine may pass anything). Both engines report the cliques in the same (lexicographic) order, and allocate all their
+ * buffers up front.
+ *
+ *   SortedListEngine -     intersects the sorted neighbor lists of the graph; the default
+ *   BitsetEngine -         stores the graph as an adjacency matrix of bits and intersects the rows with word-wide ANDs
+ *                          (4 words at a time with AVX2, when compiled with it); uses n^2/8 bytes of memory,
+ *                          so it is meant for small but dense graphs
+ */
+struct SortedListEngine
+{
+    template<class Graph, class View>
+    class Expander;
+};
+
+struct BitsetEngine
+{
+    typedef             boost::uint64_t                                 Word;
+    static const size_t word_bits = 64;
+
+    template<class Graph, class View>
+    class Expander;
+
+    // Index of the lowest set bit of x != 0
+    static unsigned     lowest_bit(Word x)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll(x);
+#else
+        static const unsigned debruijn_index[64] = {  0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+                                                     62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+                                                     63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+                                                     46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6 };
+        return debruijn_index[((x & (~x + 1)) * 0x03f79d71b4cb0a89ULL) >> 58];
+#endif
+    }
+
+    // out[i] = a[i] & b[i] for i in [0, n); returns the index one past the last non-zero word of out (0 if all are zero)
+    static size_t       intersect(const Word* a, const Word* b, Word* out, size_t n)
+    {
+        size_t i = 0;
+#ifdef __AVX2__
+        for (; i + 4 <= n; i += 4)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i))));
+#endif
+        for (; i < n; ++i)
+            out[i] = a[i] & b[i];
+
+        while (n > 0 && out[n-1] == 0)
+            --n;
+        return n;
+    }
+};
+
+
+template<class Graph, class View>
+class SortedListEngine::Expander
+{
+    public:
+        typedef             typename Graph::IndexType                       IndexType;
+        typedef             typename Graph::DistanceType                    DistanceType;
+        typedef             typename Graph::NeighborIterator                NeighborIterator;
+        typedef             typename Graph::LengthIterator                  LengthIterator;
+        typedef             typename View::Vertex                           Vertex;
+
+                            Expander(const Graph& graph): graph_(graph)     {}
+
+        // The diameters come for free with the intersections, so they are always computed
+        template<class Functor>
+        void                generate(Dimension k, const Functor& f, bool values = true)
+        {
+            // the candidates of a clique are a subset of the upper neighbors of its first vertex
+            size_t max_degree = 0;
+            for (IndexType v = 0; v < graph_.size(); ++v)
+                max_degree = std::max(max_degree, graph_.degree(v));
+            current_.resize(k + 1);
+            levels_.resize(k + 1, std::vector<IndexType>(max_degree));
+            reach_levels_.resize(k + 1, std::vector<DistanceType>(max_degree));
+
+            for (IndexType v = 0; v < graph_.size(); ++v)
+            {
+                current_[0] = v;
+                NeighborIterator upper = graph_.upper_neighbors_begin(v);
+                expand(1, 0, upper, graph_.neighbors_end(v), graph_.lengths_at(upper), k, f);
+            }
+        }
+
+    private:
+        // Reports the clique formed by the first size vertices of current_ together with its diameter, and extends 
+        // it by every vertex in [bg, end) (all of which are adjacent to every vertex in the clique); reach lists 
+        // the lengths of the longest edges connecting the candidates to the clique
+        template<class Functor>
+        void                expand(size_t size, DistanceType diameter, NeighborIterator bg, NeighborIterator end, const DistanceType* reach, 
+                                   Dimension max_dim, const Functor& f)
+        {
+            f(View(&current_[0], &current_[0] + size), diameter);
+            if (size == static_cast<size_t>(max_dim) + 1 || bg == end)
+                return;
+
+            // candidates are sorted, so the ones following cur that are adjacent to it come out sorted as well
+            IndexType*      new_candidates  = &levels_[size][0];
+            DistanceType*   new_reach       = &reach_levels_[size][0];
+            for (NeighborIterator cur = bg; cur != end; ++cur)
+            {
+                size_t              n = 0;
+                NeighborIterator    a = boost::next(cur),                       b = graph_.upper_neighbors_begin(*cur), b_end = graph_.neighbors_end(*cur);
+                const DistanceType* a_reach = reach + (a - bg);
+                LengthIterator      b_length = graph_.lengths_at(b);
+                while (a != end && b != b_end)
+                {
+                    if      (*a < *b)   { ++a; ++a_reach; }
+                    else if (*b < *a)   { ++b; ++b_length; }
+                    else
+                    {
+                        new_candidates[n]   = *a;
+                        new_reach[n]        = std::max(*a_reach, *b_length);
+                        ++n; ++a; ++a_reach; ++b; ++b_length;
+                    }
+                }
+
+                current_[size] = *cur;
+                expand(size + 1, std::max(diameter, reach[cur - bg]), new_candidates, new_candidates + n, new_reach, max_dim, f);
+            }
+        }
+
+        const Graph&                                graph_;
+        std::vector<Vertex>                         current_;
+        std::vector< std::vector<IndexType> >       levels_;            // candidates at every depth of the recursion
+        std::vector< std::vector<DistanceType> >    reach_levels_;      // and the lengths of their longest edges to the clique
+};
+
+
+template<class Graph, class View>
+class BitsetEngine::Expander
+{
+    public:
+        typedef             typename Graph::IndexType                       IndexType;
+        typedef             typename Graph::DistanceType                    DistanceType;
+        typedef             typename View::Vertex                           Vertex;
+
+        // Row v of the matrix stores the neighbors u > v (so the rows are automatically restricted to the following vertices)
+                            Expander(const Graph& graph):
+                                graph_(graph), n_(graph.size()), words_((n_ + word_bits - 1)/word_bits), rows_(n_*words_, 0)
+        {
+            for (IndexType v = 0; v < n_; ++v)
+                for (typename Graph::NeighborIterator u = graph.upper_neighbors_begin(v); u != graph.neighbors_end(v); ++u)
+                    rows_[v*words_ + *u/word_bits] |= Word(1) << (*u % word_bits);
+        }
+
+        template<class Functor>
+        void                generate(Dimension k, const Functor& f, bool values = true)
+        {
+            current_.resize(k + 1);
+            levels_.resize(k + 1, std::vector<Word>(words_));
+            for (IndexType v = 0; v < n_; ++v)
+            {
+                current_[0] = v;
+                if (values)
+                    expand<true>(1, 0, row(v), v/word_bits, words_, k, f);
+                else
+                    expand<false>(1, 0, row(v), v/word_bits, words_, k, f);
+            }
+        }
+
+    private:
+        const Word*         row(IndexType v) const                          { return &rows_[v*words_]; }
+
+        // Reports the clique formed by the first size vertices of current_ together with its diameter, and extends 
+        // it by every vertex in the set candidates, whose only non-zero words are in [begin, end)
+        template<bool values, class Functor>
+        void                expand(size_t size, DistanceType diameter, const Word* candidates, size_t begin, size_t end, 
+                                   Dimension max_dim, const Functor& f)
+        {
+            f(View(&current_[0], &current_[0] + size), diameter);
+            if (size == static_cast<size_t>(max_dim) + 1)
+                return;
+
+            // the bits of every row start after its vertex, so the words before the current one can be skipped
+            // (the new candidates before w are never read, so they need not be cleared)
+            Word* new_candidates = &levels_[size][0];
+            for (size_t w = begin; w < end; ++w)
+                for (Word bits = candidates[w]; bits; bits &= bits - 1)
+                {
+                    IndexType u = w*word_bits + lowest_bit(bits);
+                    size_t new_end = w + intersect(candidates + w, row(u) + w, new_candidates + w, end - w);
+
+                    // the matrix has no room for the lengths, so they are looked up in the graph
+                    DistanceType new_diameter = diameter;
+                    if (values)
+                        for (size_t i = 0; i < size; ++i)
+                            new_diameter = std::max(new_diameter, graph_.length(current_[i], u));
+
+                    current_[size] = u;
+                    expand<values>(size + 1, new_diameter, new_candidates, w, new_end, max_dim, f);
+                }
+        }
+
+        const Graph&                        graph_;
+        size_t                              n_, words_;
+        std::vector<Word>                   rows_;
+        std::vector<Vertex>                 current_;
+        std::vector< std::vector<Word> >    levels_;        // candidates at every depth of the recursion
+};
+
+#endif // __RIPS_ENGINES_H__
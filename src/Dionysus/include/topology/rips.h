@@ -4,6 +4,9 @@
 #include <vector>
 #include <string>
 #include "simplex.h"
+#include "neighbor-graph.h"
+#include "rips-engines.h"
+#include "edge-sweep.h"
 #include <boost/iterator/counting_iterator.hpp>
 
 
@@ -17,8 +20,11 @@
  *               provide operator()(...) which given two IndexTypes should return 
  *               the distance between them. There should be methods begin() and end() 
  *               for iterating over IndexTypes as well as a method size().
+ *
+ * Engine_ determines how the cliques of a NeighborGraph are expanded in generate(k, graph, f); 
+ *               see rips-engines.h.
  */
-template<class Distances_, class Simplex_ = Simplex<typename Distances_::IndexType> >
+template<class Distances_, class Simplex_ = Simplex<typename Distances_::IndexType>, class Engine_ = SortedListEngine>
 class Rips
 {
     public:
@@ -29,6 +35,10 @@ class Rips
         typedef             Simplex_                                        Simplex;
         typedef             typename Simplex::Vertex                        Vertex;             // should be the same as IndexType
         typedef             typename Simplex::VertexContainer               VertexContainer;
+        typedef             SimplexView<Vertex>                             View;
+
+        typedef             NeighborGraph<IndexType, DistanceType>          Graph;
+        typedef             Engine_                                         Engine;
 
         class               Evaluator;
         class               Comparison;
@@ -64,6 +74,70 @@ class Rips
         template<class Functor>
         void                generate(Dimension k, DistanceType max, const Functor& f) const
         { generate(k, max, f, boost::make_counting_iterator(distances().begin()), boost::make_counting_iterator(distances().end())); }
+
+        // Same as generate(), but f is called with a View of the vertices (valid only during the call) instead 
+        // of a Simplex. The candidates for all the levels of the recursion are stored in buffers allocated up front, 
+        // so no memory is allocated per simplex. The vertices are listed in the order they were added to the clique 
+        // (sorted if the candidates are sorted, e.g., in the overloads without them).
+        template<class Functor, class Iterator>
+        void                generate_views(Dimension k, DistanceType max, const Functor& f, 
+                                           Iterator candidates_begin, Iterator candidates_end) const;
+
+        template<class Functor>
+        void                generate_views(Dimension k, DistanceType max, const Functor& f) const
+        { generate_views(k, max, f, boost::make_counting_iterator(distances().begin()), boost::make_counting_iterator(distances().end())); }
+
+        // Same as generate_views(), but f is also passed the value of the simplex (the length of its longest edge, 
+        // i.e., what Evaluator computes). The value is maintained as the cliques are extended: every candidate 
+        // keeps the length of its longest edge to the current clique, so no distances are evaluated beyond 
+        // those needed to find the neighbors. Signature: f(const View&, DistanceType).
+        template<class Functor, class Iterator>
+        void                generate_with_values(Dimension k, DistanceType max, const Functor& f, 
+                                                 Iterator candidates_begin, Iterator candidates_end) const;
+
+        template<class Functor>
+        void                generate_with_values(Dimension k, DistanceType max, const Functor& f) const
+        { generate_with_values(k, max, f, boost::make_counting_iterator(distances().begin()), boost::make_counting_iterator(distances().end())); }
+
+        // Same as generate(), but the top level of the recursion (one task per candidate vertex) is split 
+        // across threads (0 means one per hardware thread). Each task writes into its own buffer; f is called 
+        // from the calling thread once all the tasks are done. If ordered is true, the simplices are reported 
+        // in the same order as by generate(); otherwise they are reported thread by thread.
+        // Distances must support concurrent calls to operator().
+        template<class Functor, class Iterator>
+        void                generate_parallel(Dimension k, DistanceType max, const Functor& f, 
+                                              Iterator candidates_begin, Iterator candidates_end,
+                                              unsigned threads = 0, bool ordered = true) const;
+
+        template<class Functor>
+        void                generate_parallel(Dimension k, DistanceType max, const Functor& f, 
+                                              unsigned threads = 0, bool ordered = true) const
+        { generate_parallel(k, max, f, boost::make_counting_iterator(distances().begin()), boost::make_counting_iterator(distances().end()), threads, ordered); }
+
+        // Calls functor f on each simplex in the k-skeleton of the clique complex of the graph, e.g., 
+        // Graph(distances(), max) for the Rips complex. Cliques are expanded by intersecting the sorted 
+        // neighbor lists (or their rows in the adjacency matrix, depending on the Engine), so no distances 
+        // are evaluated. The order is the same as for generate().
+        template<class Functor>
+        void                generate(Dimension k, const Graph& graph, const Functor& f) const;
+
+        template<class Functor>
+        void                generate_views(Dimension k, const Graph& graph, const Functor& f) const;
+
+        template<class Functor>
+        void                generate_with_values(Dimension k, const Graph& graph, const Functor& f) const;
+
+        // Calls f(const View&, DistanceType) on each simplex in the k-skeleton of the clique complex of the graph 
+        // together with its value, in the filtration order: sorted by value, and by dimension among the simplices 
+        // with the same value (the order Comparison would produce, up to ties), so every simplex comes after its faces 
+        // and the simplices can be passed to a persistence algorithm (e.g., CohomologyPersistence::add()) as they 
+        // are generated, without a global sort. The vertices of every View are sorted. See EdgeSweep.
+        template<class Functor>
+        void                generate_sorted(Dimension k, const Graph& graph, const Functor& f) const;
+
+        template<class Functor>
+        void                generate_sorted(Dimension k, DistanceType max, const Functor& f) const
+        { generate_sorted(k, Graph(distances(), max), f); }
         
         template<class Functor>
         void                vertex_cofaces(IndexType v, Dimension k, DistanceType max, const Functor& f) const
@@ -87,22 +161,67 @@ class Rips
     protected:
         class               WithinDistance;
 
+        // Adapt functors for generate() and generate_views() to the functors for generate_with_values(): 
+        // pass Simplex(view) or the view, respectively, and drop the value
+        template<class Functor>
+        class               SimplexFunctor;
+        template<class Functor>
+        class               ViewFunctor;
+
+        // Runs the Engine on the graph; values tells it whether f needs the values of the simplices
+        template<class Functor>
+        void                expand_graph(Dimension k, const Graph& graph, const Functor& f, bool values) const;
+
+        // Lengths of the longest edges connecting the candidates to the current clique
+        typedef             std::vector<DistanceType>                       DistanceContainer;
+
+        // Candidates at one level of the recursion
+        struct              Level
+        {
+            VertexContainer     candidates;
+            DistanceContainer   reach;
+        };
+
+        // levels[i] stores the candidates for the extensions of a clique with i+1 vertices. The capacity of each 
+        // level is reserved up front in reserve_levels() (the candidates of a level are a subset of the initial 
+        // candidates), so the recursion does not allocate any memory.
+        typedef             std::vector<Level>                              Levels;
+
+        static void         reserve_levels(VertexContainer& current, Levels& levels, Dimension max_dim, size_t candidates);
+
         template<class Functor, class NeighborTest>
         void                bron_kerbosch(VertexContainer&                          current, 
+                                          DistanceType                              diameter,
                                           const VertexContainer&                    candidates, 
+                                          const DistanceContainer&                  reach,
                                           typename VertexContainer::const_iterator  excluded,
                                           Dimension                                 max_dim,
                                           const NeighborTest&                       neighbor,
                                           const Functor&                            functor,
+                                          Levels&                                   levels,
                                           bool                                      check_initial = true) const;
+
+        // Body of the loop in bron_kerbosch(): adds *cur to current and recurses on its neighbors in candidates
+        template<class Functor, class NeighborTest>
+        void                bron_kerbosch_step(VertexContainer&                         current,
+                                               DistanceType                             diameter,
+                                               const VertexContainer&                   candidates,
+                                               const DistanceContainer&                 reach,
+                                               typename VertexContainer::const_iterator cur,
+                                               Dimension                                max_dim,
+                                               const NeighborTest&                      neighbor,
+                                               const Functor&                           functor,
+                                               Levels&                                  levels) const;
+
+        class               GenerateTask;
         
     protected:
         const Distances&    distances_;
 };
         
 
-template<class Distances_, class Simplex_>
-class Rips<Distances_, Simplex_>::WithinDistance: public std::binary_function<Vertex, Vertex, bool>
+template<class Distances_, class Simplex_, class Engine_>
+class Rips<Distances_, Simplex_, Engine_>::WithinDistance: public std::binary_function<Vertex, Vertex, bool>
 {
     public:
                             WithinDistance(const Distances_&    distances, 
@@ -110,14 +229,41 @@ class Rips<Distances_, Simplex_>::WithinDistance: public std::binary_function<Ve
                                 distances_(distances), max_(max)                        {}
 
         bool                operator()(Vertex u, Vertex v) const                        { return distances_(u, v) <= max_; }
+        bool                operator()(Vertex u, Vertex v, DistanceType& d) const       { d = distances_(u, v); return d <= max_; }
 
     protected:
         const Distances&    distances_;  
         DistanceType        max_;
 };
 
-template<class Distances_, class Simplex_>
-class Rips<Distances_, Simplex_>::Evaluator: public std::unary_function<const Simplex&, DistanceType>
+template<class Distances_, class Simplex_, class Engine_>
+template<class Functor>
+class Rips<Distances_, Simplex_, Engine_>::SimplexFunctor
+{
+    public:
+                            SimplexFunctor(const Functor& f): f_(f)                     {}
+
+        void                operator()(const View& v, DistanceType) const               { f_(Simplex(v.begin(), v.end())); }
+
+    protected:
+        const Functor&      f_;
+};
+
+template<class Distances_, class Simplex_, class Engine_>
+template<class Functor>
+class Rips<Distances_, Simplex_, Engine_>::ViewFunctor
+{
+    public:
+                            ViewFunctor(const Functor& f): f_(f)                        {}
+
+        void                operator()(const View& v, DistanceType) const               { f_(v); }
+
+    protected:
+        const Functor&      f_;
+};
+
+template<class Distances_, class Simplex_, class Engine_>
+class Rips<Distances_, Simplex_, Engine_>::Evaluator: public std::unary_function<const Simplex&, DistanceType>
 {
     public:
         typedef             Simplex_                                        Simplex;
@@ -131,8 +277,8 @@ class Rips<Distances_, Simplex_>::Evaluator: public std::unary_function<const Si
         const Distances&    distances_;
 };
 
-template<class Distances_, class Simplex_>
-class Rips<Distances_, Simplex_>::Comparison: public std::binary_function<const Simplex&, const Simplex&, bool>
+template<class Distances_, class Simplex_, class Engine_>
+class Rips<Distances_, Simplex_, Engine_>::Comparison: public std::binary_function<const Simplex&, const Simplex&, bool>
 {
     public:
         typedef             Simplex_                                        Simplex;
@@ -154,8 +300,8 @@ class Rips<Distances_, Simplex_>::Comparison: public std::binary_function<const
         Evaluator           eval_;
 };
 
-template<class Distances_, class Simplex_>
-struct Rips<Distances_, Simplex_>::ComparePair: 
+template<class Distances_, class Simplex_, class Engine_>
+struct Rips<Distances_, Simplex_, Engine_>::ComparePair: 
     public std::binary_function<const std::pair<IndexType, IndexType>&,
                                 const std::pair<IndexType, IndexType>&,
                                 bool>
@@ -5,6 +5,8 @@
 #include <utilities/log.h>
 #include <utilities/counter.h>
 #include <utilities/indirect.h>
+#include <utilities/parallel.h>
+#include <utilities/containers.h>
 #include <boost/iterator/counting_iterator.hpp>
 #include <functional>
 
@@ -17,11 +19,29 @@ static rlog::RLogChannel* rlRipsDebug =             DEF_CHANNEL("rips/debug", rl
 static Counter*  cClique =                          GetCounter("rips/clique");
 #endif // COUNTERS
 
-template<class D, class S>
+template<class D, class S, class E>
 template<class Functor, class Iterator>
 void
-Rips<D,S>::
+Rips<D,S,E>::
 generate(Dimension k, DistanceType max, const Functor& f, Iterator bg, Iterator end) const
+{
+    generate_with_values(k, max, SimplexFunctor<Functor>(f), bg, end);
+}
+
+template<class D, class S, class E>
+template<class Functor, class Iterator>
+void
+Rips<D,S,E>::
+generate_views(Dimension k, DistanceType max, const Functor& f, Iterator bg, Iterator end) const
+{
+    generate_with_values(k, max, ViewFunctor<Functor>(f), bg, end);
+}
+
+template<class D, class S, class E>
+template<class Functor, class Iterator>
+void
+Rips<D,S,E>::
+generate_with_values(Dimension k, DistanceType max, const Functor& f, Iterator bg, Iterator end) const
 {
     rLog(rlRipsDebug,       "Entered generate with %d indices", distances().size());
 
@@ -29,15 +49,129 @@ generate(Dimension k, DistanceType max, const Functor& f, Iterator bg, Iterator
 
     // current      = empty
     // candidates   = everything
-    VertexContainer current;
-    VertexContainer candidates(bg, end);
-    bron_kerbosch(current, candidates, boost::prior(candidates.begin()), k, neighbor, f);
+    VertexContainer     current;
+    VertexContainer     candidates(bg, end);
+    DistanceContainer   reach(candidates.size(), 0);
+    Levels              levels;
+    reserve_levels(current, levels, k, candidates.size());
+    bron_kerbosch(current, 0, candidates, reach, boost::prior(candidates.begin()), k, neighbor, f, levels);
 }
 
-template<class D, class S>
+template<class D, class S, class E>
+class Rips<D,S,E>::GenerateTask
+{
+    public:
+        typedef             std::vector<Simplex>                            Buffer;
+        typedef             std::vector<Buffer>                             Buffers;
+
+                            GenerateTask(const Rips& rips, const VertexContainer& candidates, const DistanceContainer& reach,
+                                         const WithinDistance& neighbor, Dimension k, Buffers& buffers, bool ordered, unsigned threads):
+                                rips_(rips), candidates_(candidates), reach_(reach), neighbor_(neighbor),
+                                k_(k), buffers_(buffers), ordered_(ordered),
+                                current_(threads), levels_(threads)
+        {
+            for (unsigned w = 0; w < threads; ++w)
+                reserve_levels(current_[w], levels_[w], k, candidates.size());
+        }
+
+        void                operator()(size_t i, unsigned w)
+        {
+            Buffer& buffer = ordered_ ? buffers_[i] : buffers_[w];
+            rips_.bron_kerbosch_step(current_[w], 0, candidates_, reach_, candidates_.begin() + i, k_, neighbor_, 
+                                     SimplexFunctor< PushBackFunctor<Buffer> >(make_push_back_functor(buffer)), levels_[w]);
+        }
+
+    private:
+        const Rips&                     rips_;
+        const VertexContainer&          candidates_;
+        const DistanceContainer&        reach_;
+        const WithinDistance&           neighbor_;
+        Dimension                       k_;
+        Buffers&                        buffers_;
+        bool                            ordered_;
+        std::vector<VertexContainer>    current_;           // per worker
+        std::vector<Levels>             levels_;            // per worker
+};
+
+template<class D, class S, class E>
 template<class Functor, class Iterator>
 void
-Rips<D,S>::
+Rips<D,S,E>::
+generate_parallel(Dimension k, DistanceType max, const Functor& f, Iterator bg, Iterator end, unsigned threads, bool ordered) const
+{
+    rLog(rlRipsDebug,       "Entered generate_parallel with %d indices", distances().size());
+
+    WithinDistance      neighbor(distances(), max);
+    VertexContainer     candidates(bg, end);
+    DistanceContainer   reach(candidates.size(), 0);
+
+    threads = default_thread_count(threads);
+    typename GenerateTask::Buffers buffers(ordered ? candidates.size() : threads);
+    GenerateTask task(*this, candidates, reach, neighbor, k, buffers, ordered, threads);
+    parallel_for(candidates.size(), task, threads);
+
+    for (typename GenerateTask::Buffers::iterator buffer = buffers.begin(); buffer != buffers.end(); ++buffer)
+    {
+        std::for_each(buffer->begin(), buffer->end(), f);
+        typename GenerateTask::Buffer().swap(*buffer);          // release the memory as we go
+    }
+}
+
+template<class D, class S, class E>
+template<class Functor>
+void
+Rips<D,S,E>::
+generate(Dimension k, const Graph& graph, const Functor& f) const
+{
+    expand_graph(k, graph, SimplexFunctor<Functor>(f), false);
+}
+
+template<class D, class S, class E>
+template<class Functor>
+void
+Rips<D,S,E>::
+generate_views(Dimension k, const Graph& graph, const Functor& f) const
+{
+    expand_graph(k, graph, ViewFunctor<Functor>(f), false);
+}
+
+template<class D, class S, class E>
+template<class Functor>
+void
+Rips<D,S,E>::
+generate_with_values(Dimension k, const Graph& graph, const Functor& f) const
+{
+    expand_graph(k, graph, f, true);
+}
+
+template<class D, class S, class E>
+template<class Functor>
+void
+Rips<D,S,E>::
+expand_graph(Dimension k, const Graph& graph, const Functor& f, bool values) const
+{
+    rLog(rlRipsDebug,       "Entered generate with a graph on %d vertices and %d edges", graph.size(), graph.edges());
+
+    typename Engine::template Expander<Graph, View> expander(graph);
+    expander.generate(k, f, values);
+}
+
+template<class D, class S, class E>
+template<class Functor>
+void
+Rips<D,S,E>::
+generate_sorted(Dimension k, const Graph& graph, const Functor& f) const
+{
+    rLog(rlRipsDebug,       "Entered generate_sorted with a graph on %d vertices and %d edges", graph.size(), graph.edges());
+
+    EdgeSweep<Graph, View> sweep(graph);
+    sweep.generate(k, f);
+}
+
+template<class D, class S, class E>
+template<class Functor, class Iterator>
+void
+Rips<D,S,E>::
 vertex_cofaces(IndexType v, Dimension k, DistanceType max, const Functor& f, Iterator bg, Iterator end) const
 {
     WithinDistance neighbor(distances(), max);
@@ -46,16 +180,23 @@ vertex_cofaces(IndexType v, Dimension k, DistanceType max, const Functor& f, Ite
     // candidates   = everything - [v]
     VertexContainer current; current.push_back(v);
     VertexContainer candidates;
+    DistanceContainer reach;
+    DistanceType d;
     for (Iterator cur = bg; cur != end; ++cur)
-        if (*cur != v && neighbor(v, *cur))
+        if (*cur != v && neighbor(v, *cur, d))
+        {
             candidates.push_back(*cur);
-    bron_kerbosch(current, candidates, boost::prior(candidates.begin()), k, neighbor, f);
+            reach.push_back(d);
+        }
+    Levels levels;
+    reserve_levels(current, levels, k, candidates.size());
+    bron_kerbosch(current, 0, candidates, reach, boost::prior(candidates.begin()), k, neighbor, SimplexFunctor<Functor>(f), levels);
 }
 
-template<class D, class S>
+template<class D, class S, class E>
 template<class Functor, class Iterator>
 void
-Rips<D,S>::
+Rips<D,S,E>::
 edge_cofaces(IndexType u, IndexType v, Dimension k, DistanceType max, const Functor& f, Iterator bg, Iterator end) const
 {
     rLog(rlRipsDebug,   "In edge_cofaces(%d, %d)", u, v);
@@ -68,20 +209,25 @@ edge_cofaces(IndexType u, IndexType v, Dimension k, DistanceType max, const Func
     VertexContainer current; current.push_back(u); current.push_back(v);
 
     VertexContainer candidates;
+    DistanceContainer reach;
+    DistanceType du, dv;
     for (Iterator cur = bg; cur != end; ++cur)
-        if (*cur != u && *cur != v && neighbor(v,*cur) && neighbor(u,*cur))
+        if (*cur != u && *cur != v && neighbor(v,*cur,dv) && neighbor(u,*cur,du))
         {
             candidates.push_back(*cur);
+            reach.push_back(std::max(du, dv));
             rLog(rlRipsDebug,   "  added candidate: %d", *cur);
         }
 
-    bron_kerbosch(current, candidates, boost::prior(candidates.begin()), k, neighbor, f);
+    Levels levels;
+    reserve_levels(current, levels, k, candidates.size());
+    bron_kerbosch(current, distances()(u,v), candidates, reach, boost::prior(candidates.begin()), k, neighbor, SimplexFunctor<Functor>(f), levels);
 }
 
-template<class D, class S>
+template<class D, class S, class E>
 template<class Functor, class Iterator>
 void
-Rips<D,S>::
+Rips<D,S,E>::
 cofaces(const Simplex& s, Dimension k, DistanceType max, const Functor& f, Iterator bg, Iterator end) const
 {
     rLog(rlRipsDebug,   "In cofaces(%s)", tostring(s).c_str());
@@ -93,6 +239,7 @@ cofaces(const Simplex& s, Dimension k, DistanceType max, const Functor& f, Itera
     
     // candidates   = everything - s.vertices()     that is a neighbor() of every vertex in the simplex
     VertexContainer candidates;
+    DistanceContainer reach;
     typedef difference_iterator<Iterator, 
                                 typename VertexContainer::const_iterator, 
                                 std::less<Vertex> >                     DifferenceIterator;
@@ -101,39 +248,63 @@ cofaces(const Simplex& s, Dimension k, DistanceType max, const Functor& f, Itera
                             ++cur)
     {
         bool nghbr = true;
+        DistanceType d, mx = 0;
         for (typename VertexContainer::const_iterator v = s.vertices().begin(); v != s.vertices().end(); ++v)
-            if (!neighbor(*v, *cur))        { nghbr = false; break; }
+        {
+            if (!neighbor(*v, *cur, d))     { nghbr = false; break; }
+            mx = std::max(mx, d);
+        }
 
         if (nghbr)  
         {
             candidates.push_back(*cur);
+            reach.push_back(mx);
             rLog(rlRipsDebug,   "  added candidate: %d", *cur);
         }
     }
 
-    bron_kerbosch(current, candidates, boost::prior(candidates.begin()), k, neighbor, f, false);
+    Levels levels;
+    reserve_levels(current, levels, k, candidates.size());
+    bron_kerbosch(current, Evaluator(distances())(s), candidates, reach, boost::prior(candidates.begin()), k, neighbor, 
+                  SimplexFunctor<Functor>(f), levels, false);
 }
 
 
-template<class D, class S>
+template<class D, class S, class E>
+void
+Rips<D,S,E>::
+reserve_levels(VertexContainer& current, Levels& levels, Dimension max_dim, size_t candidates)
+{
+    current.reserve(std::max(current.size(), static_cast<size_t>(max_dim) + 1));
+    levels.resize(std::max(current.size(), static_cast<size_t>(max_dim)) + 1);
+    for (typename Levels::iterator cur = levels.begin(); cur != levels.end(); ++cur)
+    {
+        cur->candidates.reserve(candidates);
+        cur->reach.reserve(candidates);
+    }
+}
+
+template<class D, class S, class E>
 template<class Functor, class NeighborTest>
 void
-Rips<D,S>::
+Rips<D,S,E>::
 bron_kerbosch(VertexContainer&                          current,    
+              DistanceType                              diameter,
               const VertexContainer&                    candidates,     
+              const DistanceContainer&                  reach,
               typename VertexContainer::const_iterator  excluded,
               Dimension                                 max_dim,    
               const NeighborTest&                       neighbor,       
               const Functor&                            functor,
+              Levels&                                   levels,
               bool                                      check_initial) const
 {
     rLog(rlRipsDebug,       "Entered bron_kerbosch");
     
     if (check_initial && !current.empty())
     {
-        Simplex s(current);
-        rLog(rlRipsDebug,   "Reporting simplex: %s", tostring(s).c_str());
-        functor(s);
+        rLog(rlRipsDebug,   "Reporting simplex: %s", tostring(Simplex(current)).c_str());
+        functor(View(&current[0], &current[0] + current.size()), diameter);
     }
 
     if (current.size() == static_cast<size_t>(max_dim) + 1) 
@@ -141,28 +312,58 @@ bron_kerbosch(VertexContainer&                          current,
 
     rLog(rlRipsDebug,       "Traversing %d vertices", candidates.end() - boost::next(excluded));
     for (typename VertexContainer::const_iterator cur = boost::next(excluded); cur != candidates.end(); ++cur)
-    {
-        current.push_back(*cur);
-        rLog(rlRipsDebug,   "  current.size() = %d, current.back() = %d", current.size(), current.back());
-
-        VertexContainer new_candidates;
-        for (typename VertexContainer::const_iterator ccur = candidates.begin(); ccur != cur; ++ccur)
-            if (neighbor(*ccur, *cur))
-                new_candidates.push_back(*ccur);
-        size_t ex = new_candidates.size();
-        for (typename VertexContainer::const_iterator ccur = boost::next(cur); ccur != candidates.end(); ++ccur)
-            if (neighbor(*ccur, *cur))
-                new_candidates.push_back(*ccur);
-        excluded  = new_candidates.begin() + (ex - 1);
-
-        bron_kerbosch(current, new_candidates, excluded, max_dim, neighbor, functor);
-        current.pop_back();
-    }
+        bron_kerbosch_step(current, diameter, candidates, reach, cur, max_dim, neighbor, functor, levels);
+}
+
+template<class D, class S, class E>
+template<class Functor, class NeighborTest>
+void
+Rips<D,S,E>::
+bron_kerbosch_step(VertexContainer&                         current,
+                   DistanceType                             diameter,
+                   const VertexContainer&                   candidates,
+                   const DistanceContainer&                 reach,
+                   typename VertexContainer::const_iterator cur,
+                   Dimension                                max_dim,
+                   const NeighborTest&                      neighbor,
+                   const Functor&                           functor,
+                   Levels&                                  levels) const
+{
+    VertexContainer&    new_candidates  = levels[current.size()].candidates;
+    DistanceContainer&  new_reach       = levels[current.size()].reach;
+    new_candidates.clear();
+    new_reach.clear();
+
+    current.push_back(*cur);
+    diameter = std::max(diameter, reach[cur - candidates.begin()]);
+    rLog(rlRipsDebug,   "  current.size() = %d, current.back() = %d", current.size(), current.back());
+
+    // every candidate keeps the length of its longest edge to current
+    DistanceType d;
+    typename DistanceContainer::const_iterator rcur = reach.begin();
+    for (typename VertexContainer::const_iterator ccur = candidates.begin(); ccur != cur; ++ccur, ++rcur)
+        if (neighbor(*ccur, *cur, d))
+        {
+            new_candidates.push_back(*ccur);
+            new_reach.push_back(std::max(*rcur, d));
+        }
+    size_t ex = new_candidates.size();
+    ++rcur;
+    for (typename VertexContainer::const_iterator ccur = boost::next(cur); ccur != candidates.end(); ++ccur, ++rcur)
+        if (neighbor(*ccur, *cur, d))
+        {
+            new_candidates.push_back(*ccur);
+            new_reach.push_back(std::max(*rcur, d));
+        }
+    typename VertexContainer::const_iterator excluded  = new_candidates.begin() + (ex - 1);
+
+    bron_kerbosch(current, diameter, new_candidates, new_reach, excluded, max_dim, neighbor, functor, levels);
+    current.pop_back();
 }
 
-template<class Distances_, class Simplex_>
-typename Rips<Distances_, Simplex_>::DistanceType
-Rips<Distances_, Simplex_>::
+template<class Distances_, class Simplex_, class Engine_>
+typename Rips<Distances_, Simplex_, Engine_>::DistanceType
+Rips<Distances_, Simplex_, Engine_>::
 distance(const Simplex& s1, const Simplex& s2) const
 {
     DistanceType mx = 0;
@@ -172,9 +373,9 @@ distance(const Simplex& s1, const Simplex& s2) const
     return mx;
 }
 
-template<class Distances_, class Simplex_>
-typename Rips<Distances_, Simplex_>::DistanceType
-Rips<Distances_, Simplex_>::
+template<class Distances_, class Simplex_, class Engine_>
+typename Rips<Distances_, Simplex_, Engine_>::DistanceType
+Rips<Distances_, Simplex_, Engine_>::
 max_distance() const
 {
     DistanceType mx = 0;
@@ -184,9 +385,9 @@ max_distance() const
     return mx;
 }
 
-template<class Distances_, class Simplex_>
-typename Rips<Distances_, Simplex_>::DistanceType
-Rips<Distances_, Simplex_>::Evaluator::
+template<class Distances_, class Simplex_, class Engine_>
+typename Rips<Distances_, Simplex_, Engine_>::DistanceType
+Rips<Distances_, Simplex_, Engine_>::Evaluator::
 operator()(const Simplex& s) const
 {
     DistanceType mx = 0;
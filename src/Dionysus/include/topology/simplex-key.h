@@ -0,0 +1,279 @@
+#ifndef __SIMPLEX_KEY_H__
+#define __SIMPLEX_KEY_H__
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include <boost/cstdint.hpp>
+
+#include "utilities/types.h"
+#include "utilities/log.h"
+
+
+/**
+ * Class: SimplexKeys
+ * Encodes a simplex with sorted vertices v_0 < v_1 < ... < v_k as the 64-bit integer
+ * sum_i C(v_i, i+1) (the combinatorial number system), which is unique among the simplices of the
+ * same dimension. The binomial coefficients for vertices in [0, vertices) and dimensions up to max_dim
+ * are tabulated in the constructor, so a key costs k+1 lookups, and the keys of all the facets of a
+ * simplex can be derived from its vertices in O(k) without building the facets.
+ *
+ * The largest key is C(vertices, max_dim + 1) - 1; fits() checks that it fits into Key.
+ */
+class SimplexKeys
+{
+    public:
+        typedef             boost::uint64_t                                 Key;
+
+                            SimplexKeys(size_t vertices, Dimension max_dim):
+                                vertices_(vertices), max_dim_(max_dim),
+                                binomials_((max_dim + 2)*(vertices + 1), 0)
+        {
+            AssertMsg(fits(vertices, max_dim), "Keys of the simplices must fit into 64 bits");
+            for (size_t n = 0; n <= vertices_; ++n)
+            {
+                entry(n, 0) = 1;
+                for (Dimension k = 1; k <= max_dim_ + 1 && static_cast<size_t>(k) <= n; ++k)
+                    entry(n, k) = entry(n - 1, k - 1) + entry(n - 1, k);
+            }
+        }
+
+        // Whether C(vertices, max_dim + 1) fits into Key (strictly below the largest Key,
+        // which is reserved by SimplexKeyMap)
+        static bool         fits(size_t vertices, Dimension max_dim)
+        {
+            const Key max = std::numeric_limits<Key>::max();
+            Key b = 1;                          // C(vertices, k) = C(vertices, k-1)*(vertices - k + 1)/k
+            for (Dimension k = 1; k <= max_dim + 1 && static_cast<size_t>(k) <= vertices; ++k)
+            {
+                Key m = vertices - k + 1;
+                if (b > (max - 1)/m) return false;
+                b = b*m/k;
+            }
+            return true;
+        }
+
+        size_t              vertices() const                                { return vertices_; }
+        Dimension           max_dimension() const                           { return max_dim_; }
+
+        // C(n, k) for n <= vertices(), k <= max_dimension() + 1
+        Key                 binomial(size_t n, Dimension k) const           { return binomials_[k*(vertices_ + 1) + n]; }
+
+        // Key of the simplex with the sorted vertices [bg, end)
+        template<class Iterator>
+        Key                 key(Iterator bg, Iterator end) const
+        {
+            Key k = 0;
+            for (Dimension i = 1; bg != end; ++bg, ++i)
+                k += binomial(*bg, i);
+            return k;
+        }
+
+        // Writes the keys of the facets of the simplex with the sorted vertices [bg, end) into out,
+        // in the order of Simplex::BoundaryIterator (the facet without the i-th vertex comes i-th)
+        template<class Iterator, class OutputIterator>
+        void                boundary(Iterator bg, Iterator end, OutputIterator out) const
+        {
+            // the vertices before the removed one keep their positions, the ones after it move down by one
+            Dimension size = end - bg;
+            if (size < 2)
+                return;
+
+            Key after = 0;                      // sum over the vertices after the removed one, shifted down
+            for (Dimension i = 1; i < size; ++i)
+                after += binomial(bg[i], i);
+
+            Key before = 0;
+            for (Dimension i = 0; i < size; ++i)
+            {
+                *out++ = before + after;
+                if (i + 1 < size)
+                {
+                    before += binomial(bg[i], i + 1);
+                    after  -= binomial(bg[i + 1], i + 1);
+                }
+            }
+        }
+
+        // Writes the sorted vertices of the dim-dimensional simplex with key k into out[0], ..., out[dim]
+        // (the inverse of key())
+        template<class RandomAccessIterator>
+        void                vertices(Key k, Dimension dim, RandomAccessIterator out) const
+        {
+            // the last vertex is the largest v with C(v, dim+1) <= k; the rest is the key of the remaining vertices
+            size_t upper = vertices_;
+            for (Dimension i = dim; i >= 0; --i)
+            {
+                const Key* row = &binomials_[(i + 1)*(vertices_ + 1)];
+                size_t v = std::upper_bound(row, row + upper, k) - row - 1;
+                out[i] = v;
+                k -= row[v];
+                upper = v;
+            }
+        }
+
+    private:
+        Key&                entry(size_t n, Dimension k)                    { return binomials_[k*(vertices_ + 1) + n]; }
+
+        size_t              vertices_;
+        Dimension           max_dim_;
+        std::vector<Key>    binomials_;
+};
+
+
+/**
+ * Class: SimplexKeyMap
+ * Maps the keys of the simplices (see SimplexKeys) of every dimension up to max_dim to values,
+ * e.g., to their positions in a filtration or to their indices in a persistence algorithm. Every dimension
+ * has its own open addressing table with linear probing, which doubles once it is half full, so lookups
+ * take O(1) expected time and touch a few consecutive entries. (The keys of vertices are the vertices
+ * themselves, so dimension 0 is a direct index in all but name.)
+ *
+ * Parameter:
+ *   Value_ -       type of the values
+ */
+template<class Value_>
+class SimplexKeyMap
+{
+    public:
+        typedef             Value_                                          Value;
+        typedef             SimplexKeys::Key                                Key;
+
+                            SimplexKeyMap(Dimension max_dim):
+                                tables_(max_dim + 1)                        {}
+
+        // Reserves room for n simplices of dimension d
+        void                reserve(Dimension d, size_t n)                  { if (2*n > tables_[d].entries.size()) tables_[d].rehash(2*n); }
+
+        // Maps the key k of a d-dimensional simplex to value (replacing the previous value, if any)
+        void                insert(Dimension d, Key k, const Value& value)  { tables_[d].insert(k, value); }
+        // Returns the value of the key k (0 if it is not in the map)
+        const Value*        find(Dimension d, Key k) const                  { return tables_[d].find(k); }
+        Value*              find(Dimension d, Key k)                        { return const_cast<Value*>(tables_[d].find(k)); }
+        // The key k must be in the map
+        const Value&        operator()(Dimension d, Key k) const            { return *find(d, k); }
+        Value&              operator()(Dimension d, Key k)                  { return *find(d, k); }
+        bool                erase(Dimension d, Key k)                       { return tables_[d].erase(k); }
+
+        size_t              size(Dimension d) const                         { return tables_[d].size; }
+        size_t              size() const;
+        Dimension           max_dimension() const                           { return tables_.size() - 1; }
+
+        // Maps the key of every simplex of dimension at most max_dimension() in the filtration to its position
+        template<class Filtration>
+        void                index(const Filtration& filtration, const SimplexKeys& keys);
+
+    private:
+        static const Key    empty = ~Key(0);                                // never a key (see SimplexKeys::fits())
+
+        struct              Entry
+        {
+                            Entry(): key(empty)                             {}
+            Key             key;
+            Value           value;
+        };
+
+        struct              Table
+        {
+                            Table(): size(0)                                {}
+
+            // Fibonacci hashing: consecutive keys (common among the faces of a simplex) are spread out
+            size_t          slot(Key k) const                               { return (k * 0x9e3779b97f4a7c15ULL) >> shift; }
+
+            const Value*    find(Key k) const
+            {
+                if (entries.empty()) return 0;
+                for (size_t i = slot(k); ; i = (i + 1) & (entries.size() - 1))
+                {
+                    if (entries[i].key == k)        return &entries[i].value;
+                    if (entries[i].key == empty)    return 0;
+                }
+            }
+
+            void            insert(Key k, const Value& value)
+            {
+                if (2*(size + 1) > entries.size())
+                    rehash(2*(size + 1));
+                size_t i = slot(k);
+                while (entries[i].key != empty && entries[i].key != k)
+                    i = (i + 1) & (entries.size() - 1);
+                if (entries[i].key == empty)
+                    ++size;
+                entries[i].key = k; entries[i].value = value;
+            }
+
+            // Backward shift deletion: moves the following entries of the cluster into the hole, so no tombstones are needed
+            bool            erase(Key k)
+            {
+                if (entries.empty()) return false;
+                size_t mask = entries.size() - 1, i = slot(k);
+                while (entries[i].key != k)
+                {
+                    if (entries[i].key == empty) return false;
+                    i = (i + 1) & mask;
+                }
+                for (size_t j = (i + 1) & mask; entries[j].key != empty; j = (j + 1) & mask)
+                {
+                    size_t home = slot(entries[j].key);
+                    // entries[j] can move into the hole at i unless its home slot lies cyclically in (i, j]
+                    if (((j - home) & mask) >= ((j - i) & mask))
+                    {
+                        entries[i] = entries[j];
+                        i = j;
+                    }
+                }
+                entries[i] = Entry();
+                --size;
+                return true;
+            }
+
+            // Grows the table to a power of two not smaller than n (and at least 16)
+            void            rehash(size_t n)
+            {
+                size_t capacity = 16; shift = 60;
+                while (capacity < n) { capacity *= 2; --shift; }
+
+                std::vector<Entry> old(capacity);
+                old.swap(entries);
+                size = 0;
+                for (size_t i = 0; i < old.size(); ++i)
+                    if (old[i].key != empty)
+                        insert(old[i].key, old[i].value);
+            }
+
+            std::vector<Entry>  entries;
+            size_t              size;
+            unsigned            shift;
+        };
+
+        std::vector<Table>  tables_;
+};
+
+template<class V>
+size_t
+SimplexKeyMap<V>::
+size() const
+{
+    size_t s = 0;
+    for (size_t d = 0; d < tables_.size(); ++d)
+        s += tables_[d].size;
+    return s;
+}
+
+template<class V>
+template<class Filtration>
+void
+SimplexKeyMap<V>::
+index(const Filtration& filtration, const SimplexKeys& keys)
+{
+    unsigned i = 0;
+    for (typename Filtration::Index cur = filtration.begin(); cur != filtration.end(); ++cur, ++i)
+    {
+        const typename Filtration::Simplex& s = filtration.simplex(cur);
+        if (s.dimension() <= max_dimension())
+            insert(s.dimension(), keys.key(s.vertices().begin(), s.vertices().end()), i);
+    }
+}
+
+#endif // __SIMPLEX_KEY_H__
@@ -213,6 +213,38 @@ struct Simplex<V,T>::DimensionExtractor
 };
 
 
+/**
+ * Class: SimplexView
+ * Lightweight view of the vertices of a simplex stored elsewhere (e.g., in the buffers of Rips during
+ * the enumeration); it does not own the vertices and is valid only as long as their storage.
+ * Simplex(view.begin(), view.end()) copies it into a proper simplex.
+ *
+ * Parameter:
+ *   V -            vertex type
+ */
+template<class V>
+class SimplexView
+{
+    public:
+        typedef     V                                                               Vertex;
+        typedef     const Vertex*                                                   const_iterator;
+        typedef     const_iterator                                                  iterator;
+
+                                SimplexView(const_iterator bg, const_iterator end):
+                                    begin_(bg), end_(end)                           {}
+
+        const_iterator          begin() const                                       { return begin_; }
+        const_iterator          end() const                                         { return end_; }
+        size_t                  size() const                                        { return end_ - begin_; }
+        const Vertex&           operator[](size_t i) const                          { return begin_[i]; }
+
+        Dimension               dimension() const                                   { return size() - 1; }
+
+    private:
+        const_iterator          begin_, end_;
+};
+
+
 // TODO: class DirectSimplex - class which stores indices of the simplices in its boundary
 // TODO: class CompactSimplex<V, T, N> - uses arrays instead of vectors to store simplices 
 //       (dimension N must be known at compile time)
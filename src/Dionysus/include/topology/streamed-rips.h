@@ -0,0 +1,93 @@
+#ifndef __STREAMED_RIPS_H__
+#define __STREAMED_RIPS_H__
+
+#include <vector>
+#include <algorithm>
+
+#include "simplex.h"
+#include "simplex-key.h"
+#include "neighbor-graph.h"
+#include "edge-sweep.h"
+
+
+/**
+ * Class: StreamedRipsFiltration
+ * Filtration of the k-skeleton of the Rips complex VR(max) that streams its simplices instead of storing
+ * them. It keeps only the edges within max (in a NeighborGraph) and the binomial coefficients of SimplexKeys:
+ * a simplex is identified by its key and dimension, and its vertices, value (the length of its longest edge),
+ * and facets are computed from them. generate() passes the simplices to a functor in the filtration order
+ * (by value, then by dimension; see EdgeSweep); whoever needs them afterwards (e.g., RipsCohomology, for
+ * the simplices below the top dimension) keeps them.
+ *
+ * Distances_ is the same as for Rips.
+ */
+template<class Distances_>
+class StreamedRipsFiltration
+{
+    public:
+        typedef             Distances_                                      Distances;
+        typedef             typename Distances::IndexType                   IndexType;
+        typedef             typename Distances::DistanceType                DistanceType;
+
+        typedef             NeighborGraph<IndexType, DistanceType>          Graph;
+        typedef             SimplexKeys::Key                                Key;
+        typedef             SimplexView<IndexType>                          View;
+        typedef             EdgeSweep<Graph, View>                          Sweep;
+        typedef             typename Graph::NeighborIterator                NeighborIterator;
+
+        // Evaluates every distance once (see NeighborGraph)
+                            StreamedRipsFiltration(const Distances& distances, Dimension skeleton, DistanceType max, unsigned threads = 1):
+                                graph_(distances, max, threads), keys_(graph_.size(), skeleton), sweep_(graph_), skeleton_(skeleton)   {}
+
+        Dimension           skeleton() const                                { return skeleton_; }
+        const Graph&        graph() const                                   { return graph_; }
+        const SimplexKeys&  keys() const                                    { return keys_; }
+
+        // Calls f(const View&, DistanceType) on every simplex (with sorted vertices) and its value in the filtration order
+        template<class Functor>
+        void                generate(const Functor& f) const                { sweep_.generate(skeleton_, f); }
+
+        // Key of the simplex with the sorted vertices [bg, end), and the inverse
+        template<class Iterator>
+        Key                 key(Iterator bg, Iterator end) const            { return keys_.key(bg, end); }
+        template<class RandomAccessIterator>
+        void                vertices(Key k, Dimension d, RandomAccessIterator out) const    { keys_.vertices(k, d, out); }
+
+        // Value of the simplex with the sorted vertices [bg, end) (all its edges must be in the graph)
+        template<class Iterator>
+        DistanceType        value(Iterator bg, Iterator end) const;
+
+        // Writes the keys of the facets of the simplex with the sorted vertices [bg, end) into out
+        // (in the order of Simplex::BoundaryIterator)
+        template<class Iterator, class OutputIterator>
+        void                facets(Iterator bg, Iterator end, OutputIterator out) const    { keys_.boundary(bg, end, out); }
+
+        // Whether the simplex that generate() has just passed to the functor is the younger half of an apparent pair
+        // in the filtration order: it's the youngest facet of its oldest cofacet (see CohomologyPersistence::add_apparent())
+        bool                apparent() const                                { return sweep_.apparent(); }
+
+    private:
+                            StreamedRipsFiltration(const StreamedRipsFiltration&);     // sweep_ refers to graph_
+        void                operator=(const StreamedRipsFiltration&);
+
+        Graph               graph_;
+        SimplexKeys         keys_;
+        mutable Sweep       sweep_;
+        Dimension           skeleton_;
+};
+
+
+template<class D>
+template<class Iterator>
+typename StreamedRipsFiltration<D>::DistanceType
+StreamedRipsFiltration<D>::
+value(Iterator bg, Iterator end) const
+{
+    DistanceType value = 0;
+    for (Iterator u = bg; u != end; ++u)
+        for (Iterator v = boost::next(u); v != end; ++v)
+            value = std::max(value, graph_.length(*u, *v));
+    return value;
+}
+
+#endif // __STREAMED_RIPS_H__
@@ -0,0 +1,166 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/exception_ptr.hpp>
+
+
+/**
+ * Class: WorkStealingQueue
+ * Distributes task indices [0, n) among a fixed number of workers. Every worker starts with
+ * a contiguous block of the range and consumes it from the front; once its block is exhausted
+ * it steals the back half of the largest remaining block. Tasks are expected to be coarse
+ * (e.g., a whole subtree of a recursion), so a single mutex guards all the blocks.
+ */
+class WorkStealingQueue
+{
+    public:
+        typedef                 std::pair<size_t, size_t>                       Range;
+
+                                WorkStealingQueue(size_t n, unsigned workers):
+                                    ranges_(workers)
+        {
+            for (unsigned w = 0; w < workers; ++w)
+                ranges_[w] = Range(n*w/workers, n*(w+1)/workers);
+        }
+
+        // Stores the next task for worker w in task; returns false once everything is done
+        bool                    pop(unsigned w, size_t& task)
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+
+            if (ranges_[w].first == ranges_[w].second)
+            {
+                unsigned victim = w;
+                for (unsigned v = 0; v < ranges_.size(); ++v)
+                    if (size(v) > size(victim))
+                        victim = v;
+                if (victim == w)
+                    return false;
+
+                size_t middle = ranges_[victim].first + size(victim)/2;
+                ranges_[w] = Range(middle, ranges_[victim].second);
+                ranges_[victim].second = middle;
+            }
+
+            task = ranges_[w].first++;
+            return true;
+        }
+
+        // Drops the tasks that haven't started, so every pop() returns false from now on
+        void                    stop()
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            for (unsigned w = 0; w < ranges_.size(); ++w)
+                ranges_[w].first = ranges_[w].second;
+        }
+
+    private:
+        size_t                  size(unsigned w) const                          { return ranges_[w].second - ranges_[w].first; }
+
+        std::vector<Range>      ranges_;
+        boost::mutex            mutex_;
+};
+
+// The first exception thrown by a task of parallel_for(), to be rethrown on the calling thread
+class ParallelForError
+{
+    public:
+        void                    set(const boost::exception_ptr& error)
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            if (!error_)
+                error_ = error;
+        }
+
+        // Only once the workers are joined
+        const boost::exception_ptr&
+                                get() const                                     { return error_; }
+
+    private:
+        boost::exception_ptr    error_;
+        boost::mutex            mutex_;
+};
+
+// Body of a single parallel_for() thread; it never throws (an exception on a boost::thread would call std::terminate()),
+// but records the exception of a task and stops the queue
+template<class Task>
+class ParallelForWorker
+{
+    public:
+                                ParallelForWorker(Task& task, WorkStealingQueue& queue, ParallelForError& error, unsigned w):
+                                    task_(&task), queue_(&queue), error_(&error), w_(w)     {}
+
+        void                    operator()() const
+        {
+            try
+            {
+                size_t i = 0;
+                while (queue_->pop(w_, i))
+                    (*task_)(i, w_);
+            }
+            catch (...)
+            {
+                error_->set(boost::current_exception());
+                queue_->stop();
+            }
+        }
+
+    private:
+        Task*                   task_;
+        WorkStealingQueue*      queue_;
+        ParallelForError*       error_;
+        unsigned                w_;
+};
+
+inline unsigned
+default_thread_count(unsigned threads = 0)
+{
+    if (threads == 0)
+        threads = boost::thread::hardware_concurrency();
+    return std::max(threads, 1u);
+}
+
+/**
+ * Function: parallel_for(n, task, threads)
+ * Calls task(i, w) for every i in [0, n) where w < threads identifies the calling worker.
+ * If threads is 0, the number of hardware threads is used. The calls are distributed
+ * through a WorkStealingQueue; the function returns once all of them are done.
+ *
+ * If a call throws, the tasks that haven't started are dropped, the ones in progress finish, and once
+ * all the threads are joined, the (first) exception is rethrown on the calling thread.
+ */
+template<class Task>
+void
+parallel_for(size_t n, Task& task, unsigned threads = 0)
+{
+    threads = default_thread_count(threads);
+    WorkStealingQueue queue(n, threads);
+    ParallelForError  error;
+
+    boost::thread_group workers;
+    try
+    {
+        for (unsigned w = 1; w < threads; ++w)
+            workers.create_thread(ParallelForWorker<Task>(task, queue, error, w));
+    }
+    catch (...)
+    {
+        queue.stop();                                   // the threads already running must not outlive queue and task
+        workers.join_all();
+        throw;
+    }
+    ParallelForWorker<Task>(task, queue, error, 0)();   // the calling thread is worker 0
+    workers.join_all();
+
+    if (error.get())
+        boost::rethrow_exception(error.get());
+}
+
+#endif // __PARALLEL_H__
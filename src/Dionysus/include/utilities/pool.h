@@ -0,0 +1,266 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <vector>
+#include <algorithm>
+#include <new>
+#include <cstddef>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+#include <boost/utility/enable_if.hpp>
+
+
+/**
+ * Class: Pool
+ * Allocates objects of type T in large blocks of contiguous memory, and recycles the destroyed ones
+ * through a free list. There is no per-object overhead of the general purpose allocator, the objects
+ * allocated one after another are next to each other in memory, and their addresses never change.
+ * The objects still alive when the pool is destroyed are destroyed with it.
+ */
+template<class T>
+class Pool
+{
+    public:
+                            Pool(size_t block_size = 4096):
+                                block_size_(block_size), free_(0), next_(0), end_(0)        {}
+                            ~Pool()
+        {
+            // every slot that was handed out and is not on the free list is alive
+            std::vector<char*> free;
+            for (Free* f = free_; f; f = f->next)
+                free.push_back(reinterpret_cast<char*>(f));
+            std::sort(free.begin(), free.end());
+
+            for (size_t i = 0; i < blocks_.size(); ++i)
+            {
+                char* end = (i + 1 == blocks_.size()) ? next_ : blocks_[i] + block_size_*slot_size;
+                for (char* p = blocks_[i]; p != end; p += slot_size)
+                    if (!std::binary_search(free.begin(), free.end(), p))
+                        reinterpret_cast<T*>(p)->~T();
+                ::operator delete(blocks_[i]);
+            }
+        }
+
+        // If the copy constructor of T throws, the slot goes back to the free list (so ~Pool() doesn't destroy it)
+        T*                  construct(const T& x)
+        {
+            void* p = allocate();
+            try
+            {
+                return new (p) T(x);
+            }
+            catch (...)
+            {
+                deallocate(p);
+                throw;
+            }
+        }
+        void                destroy(T* p)                                   { p->~T(); deallocate(p); }
+
+        // Memory taken by the blocks
+        size_t              capacity() const                                { return blocks_.size()*block_size_*slot_size; }
+
+    private:
+        // Slot of the free list (stored in place of a destroyed object)
+        struct              Free                                            { Free* next; };
+
+        static const size_t alignment = boost::alignment_of<T>::value > boost::alignment_of<Free>::value ?
+                                        boost::alignment_of<T>::value : boost::alignment_of<Free>::value;
+        static const size_t slot_size = ((sizeof(T) > sizeof(Free) ? sizeof(T) : sizeof(Free)) + alignment - 1)
+                                        / alignment * alignment;
+
+        void*               allocate()
+        {
+            if (free_)
+            {
+                Free* p = free_;
+                free_ = free_->next;
+                return p;
+            }
+            if (next_ == end_)
+            {
+                char* block = static_cast<char*>(::operator new(block_size_*slot_size));
+                try
+                {
+                    blocks_.push_back(block);
+                }
+                catch (...)
+                {
+                    ::operator delete(block);
+                    throw;
+                }
+                next_ = block;
+                end_  = next_ + block_size_*slot_size;
+            }
+            void* p = next_;
+            next_ += slot_size;
+            return p;
+        }
+
+        void                deallocate(void* p)
+        {
+            Free* f = static_cast<Free*>(p);
+            f->next = free_;
+            free_ = f;
+        }
+
+                            Pool(const Pool&);
+        void                operator=(const Pool&);
+
+        size_t              block_size_;
+        std::vector<char*>  blocks_;
+        Free*               free_;
+        char*               next_;
+        char*               end_;
+};
+
+
+/**
+ * Class: PooledStore
+ * Objects of type T in a Pool, in no particular order (so without the links of a list), for the containers that are
+ * never traversed. Iterators are pointers to the objects; end() is the null pointer. Same interface as PooledList
+ * for insertion and removal (the position of insert() is ignored).
+ */
+template<class T>
+class PooledStore
+{
+    public:
+        typedef             T                                               value_type;
+        typedef             T*                                              iterator;
+        typedef             const T*                                        const_iterator;
+
+                            PooledStore(): size_(0)                         {}
+
+        iterator            end() const                                     { return 0; }
+        bool                empty() const                                   { return size_ == 0; }
+        size_t              size() const                                    { return size_; }
+
+        iterator            insert(iterator, const T& x)                    { iterator p = objects_.construct(x); ++size_; return p; }
+        void                erase(iterator pos)                             { --size_; objects_.destroy(pos); }
+
+        // Memory taken by the objects
+        size_t              capacity() const                                { return objects_.capacity(); }
+
+    private:
+        size_t              size_;
+        Pool<T>             objects_;
+};
+
+
+/**
+ * Class: PooledList
+ * Doubly-linked list with the interface of std::list (the part of it used in this library), whose nodes are allocated
+ * from a Pool. Iterators are plain pointers to the nodes, and stay valid until their elements are erased.
+ */
+template<class T>
+class PooledList
+{
+    private:
+        struct              Link
+        {
+                            Link(): prev(this), next(this)                  {}
+            Link*           prev;
+            Link*           next;
+        };
+
+        struct              Node: public Link
+        {
+                            Node(const T& x): value(x)                      {}
+            T               value;
+        };
+
+        template<class Value>
+        class               Iterator;
+
+    public:
+        typedef             T                                               value_type;
+        typedef             T&                                              reference;
+        typedef             const T&                                        const_reference;
+        typedef             Iterator<T>                                     iterator;
+        typedef             Iterator<const T>                               const_iterator;
+
+                            PooledList(): size_(0)                          {}
+
+        iterator            begin()                                         { return iterator(head_.next); }
+        iterator            end()                                           { return iterator(&head_); }
+        const_iterator      begin() const                                   { return const_iterator(head_.next); }
+        const_iterator      end() const                                     { return const_iterator(const_cast<Link*>(&head_)); }
+
+        bool                empty() const                                   { return size_ == 0; }
+        size_t              size() const                                    { return size_; }
+
+        reference           front()                                         { return static_cast<Node*>(head_.next)->value; }
+        reference           back()                                          { return static_cast<Node*>(head_.prev)->value; }
+        const_reference     front() const                                   { return static_cast<const Node*>(head_.next)->value; }
+        const_reference     back() const                                    { return static_cast<const Node*>(head_.prev)->value; }
+
+        // Inserts x before pos
+        iterator            insert(iterator pos, const T& x)
+        {
+            Link* n = nodes_.construct(Node(x));
+            n->next = pos.link_; n->prev = pos.link_->prev;
+            n->prev->next = n; n->next->prev = n;
+            ++size_;
+            return iterator(n);
+        }
+        iterator            erase(iterator pos)
+        {
+            Link* n = pos.link_;
+            Link* next = n->next;
+            n->prev->next = next; next->prev = n->prev;
+            nodes_.destroy(static_cast<Node*>(n));
+            --size_;
+            return iterator(next);
+        }
+
+        void                push_back(const T& x)                           { insert(end(), x); }
+        void                push_front(const T& x)                          { insert(begin(), x); }
+        void                pop_back()                                      { erase(iterator(head_.prev)); }
+        void                pop_front()                                     { erase(begin()); }
+        void                clear()                                         { while (!empty()) pop_back(); }
+
+        // Memory taken by the nodes
+        size_t              capacity() const                                { return nodes_.capacity(); }
+
+    private:
+                            PooledList(const PooledList&);
+        void                operator=(const PooledList&);
+
+        Link                head_;
+        size_t              size_;
+        Pool<Node>          nodes_;
+};
+
+template<class T>
+template<class Value>
+class PooledList<T>::Iterator: public boost::iterator_facade<Iterator<Value>, Value, boost::bidirectional_traversal_tag>
+{
+        struct              enabler                                         {};
+
+    public:
+                            Iterator(): link_(0)                            {}
+        explicit            Iterator(Link* link): link_(link)               {}
+
+        // iterator converts to const_iterator
+        template<class Other>
+                            Iterator(const Iterator<Other>& other,
+                                     typename boost::enable_if<boost::is_convertible<Other*, Value*>, enabler>::type = enabler()):
+                                link_(other.link_)                          {}
+
+    private:
+        friend class        boost::iterator_core_access;
+        friend class        PooledList;
+        template<class>
+        friend class        Iterator;
+
+        Value&              dereference() const                             { return static_cast<Node*>(link_)->value; }
+        bool                equal(const Iterator& other) const              { return link_ == other.link_; }
+        void                increment()                                     { link_ = link_->next; }
+        void                decrement()                                     { link_ = link_->prev; }
+
+        Link*               link_;
+};
+
+#endif // __POOL_H__
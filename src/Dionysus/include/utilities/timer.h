@@ -15,6 +15,7 @@ class Timer
         void        start();
         void        stop();
         void        check(const char* msg = 0) const;
+        double      total() const                                           { return acc_time; }
 
     private:
         clock_t     start_clock;
@@ -13,6 +13,7 @@ typedef		double					RealType;
 typedef		unsigned int			SizeType;
 
 static RealType Infinity = std::numeric_limits<RealType>::infinity();
+static const RealType TwoPi = 6.28318530717958647692528676655900577;
 
 typedef 	const unsigned int&		version_type;
 
@@ -0,0 +1,84 @@
+#include <geometry/kd-tree.h>
+#include <topology/neighbor-graph.h>
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+// Checks that the NeighborGraph with the candidates of a KDTree is the same as the one of all the pairs,
+// for points in general position and for points with many equal coordinates (ties at the splits)
+
+struct Distances
+{
+	typedef			unsigned		IndexType;
+	typedef			double			DistanceType;
+
+					Distances(const std::vector<double>& points, size_t dimension):
+						points_(points), dimension_(dimension)					{}
+
+	DistanceType	operator()(IndexType a, IndexType b) const
+	{
+		double s = 0;
+		for (size_t k = 0; k < dimension_; ++k)
+		{
+			double d = points_[a*dimension_ + k] - points_[b*dimension_ + k];
+			s += d*d;
+		}
+		return std::sqrt(s);
+	}
+
+	size_t			size() const											{ return points_.size()/dimension_; }
+	IndexType		begin() const											{ return 0; }
+	IndexType		end() const												{ return size(); }
+
+	const std::vector<double>&	points_;
+	size_t						dimension_;
+};
+
+typedef			NeighborGraph<unsigned, double>		Graph;
+
+bool same(const Graph& g1, const Graph& g2)
+{
+	if (g1.size() != g2.size() || g1.edges() != g2.edges())
+		return false;
+	for (unsigned v = 0; v < g1.size(); ++v)
+		if (g1.neighbors_end(v) - g1.neighbors_begin(v) != g2.neighbors_end(v) - g2.neighbors_begin(v) ||
+			!std::equal(g1.neighbors_begin(v), g1.neighbors_end(v), g2.neighbors_begin(v)))
+			return false;
+	return true;
+}
+
+bool check(size_t n, size_t dimension, double max, bool grid, size_t leaf_size, unsigned threads)
+{
+	std::vector<double> points(n*dimension);
+	for (size_t i = 0; i < points.size(); ++i)
+		points[i] = grid ? rand() % 5 / 4. : rand()/double(RAND_MAX);
+
+	Distances	distances(points, dimension);
+	KDTree		tree(&points[0], n, dimension, leaf_size);
+
+	Graph		all(distances, max, threads),
+				candidates(distances, tree, max, threads);
+
+	bool ok = same(all, candidates);
+	std::cout << n << " points in R^" << dimension << (grid ? " (grid)" : "") << ", max = " << max
+			  << ", leaf size " << leaf_size << ", " << threads << " thread(s): "
+			  << all.edges() << " edges" << (ok ? "" : ", DIFFERENT GRAPHS") << std::endl;
+	return ok;
+}
+
+int main()
+{
+	srand(1);
+
+	bool ok = true;
+	ok &= check(2000, 1, .01,  false, 16, 1);
+	ok &= check(2000, 3, .1,   false, 16, 1);
+	ok &= check(2000, 5, .3,   false,  4, 4);
+	ok &= check(1000, 3, .25,  true,  16, 2);       // the points at distance exactly max are edges
+	ok &= check(10,   2, 2.,   false, 16, 1);       // a single leaf, a complete graph
+
+	return ok ? 0 : 1;
+}
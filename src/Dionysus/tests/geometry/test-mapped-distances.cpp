@@ -0,0 +1,139 @@
+#include <geometry/mapped-distances.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+// Checks that MappedDistances reads back what write() wrote, for both value types and both layouts, and
+// that it rejects the files that are not (complete) files of distances
+
+struct Distances
+{
+	typedef			unsigned		IndexType;
+	typedef			double			DistanceType;
+
+					Distances(const std::vector<double>& points, size_t dimension):
+						points_(points), dimension_(dimension)					{}
+
+	DistanceType	operator()(IndexType a, IndexType b) const
+	{
+		double s = 0;
+		for (size_t k = 0; k < dimension_; ++k)
+		{
+			double d = points_[a*dimension_ + k] - points_[b*dimension_ + k];
+			s += d*d;
+		}
+		return std::sqrt(s);
+	}
+
+	size_t			size() const											{ return points_.size()/dimension_; }
+	IndexType		begin() const											{ return 0; }
+	IndexType		end() const												{ return size(); }
+
+	const std::vector<double>&	points_;
+	size_t						dimension_;
+};
+
+const char*		filename = "test-mapped-distances.dist";
+
+std::string read_file(const char* name)
+{
+	std::ifstream in(name, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const char* name, const std::string& contents)
+{
+	std::ofstream out(name, std::ios::binary);
+	out.write(contents.data(), contents.size());
+}
+
+bool round_trip(const Distances& distances, MappedDistances::ValueType type, MappedDistances::Layout layout)
+{
+	std::string error;
+	if (!MappedDistances::write(filename, distances, type, layout, 0x0123456789abcdefULL, 2, &error))
+	{
+		std::cout << "Cannot write: " << error << std::endl;
+		return false;
+	}
+
+	MappedDistances mapped(filename);
+	if (!mapped.valid())
+	{
+		std::cout << "Cannot open: " << mapped.error() << std::endl;
+		return false;
+	}
+	if (mapped.size() != distances.size() || mapped.key() != 0x0123456789abcdefULL ||
+		mapped.value_type() != type || mapped.layout() != layout)
+	{
+		std::cout << "Wrong header" << std::endl;
+		return false;
+	}
+	if (read_file(filename).size() != MappedDistances::bytes(distances.size(), type, layout))
+	{
+		std::cout << "Wrong length of the file" << std::endl;
+		return false;
+	}
+
+	for (unsigned a = 0; a < distances.size(); ++a)
+		for (unsigned b = 0; b < distances.size(); ++b)
+		{
+			double expected = type == MappedDistances::float64 ? distances(a, b) : float(distances(a, b));
+			if (mapped(a, b) != expected)
+			{
+				std::cout << "Wrong distance " << mapped(a, b) << " between " << a << " and " << b
+						  << " instead of " << expected << std::endl;
+				return false;
+			}
+		}
+	return true;
+}
+
+bool rejects(const std::string& contents, const char* what)
+{
+	write_file(filename, contents);
+	MappedDistances mapped(filename);
+	std::cout << what << ": " << (mapped.valid() ? "opened" : mapped.error()) << std::endl;
+	return !mapped.valid() && !mapped.error().empty();
+}
+
+int main()
+{
+	const size_t n = 100, dimension = 3;
+
+	std::vector<double> points(n*dimension);
+	srand(1);
+	for (size_t i = 0; i < points.size(); ++i)
+		points[i] = rand()/double(RAND_MAX);
+	Distances distances(points, dimension);
+
+	bool ok = true;
+	ok &= round_trip(distances, MappedDistances::float64, MappedDistances::condensed);
+	ok &= round_trip(distances, MappedDistances::float64, MappedDistances::upper);
+	ok &= round_trip(distances, MappedDistances::float32, MappedDistances::condensed);
+	ok &= round_trip(distances, MappedDistances::float32, MappedDistances::upper);
+	if (ok)
+		std::cout << "Read back the distances of " << n << " points" << std::endl;
+
+	MappedDistances::write(filename, distances);
+	std::string file = read_file(filename);
+	size_t header = sizeof(MappedDistancesHeader);
+
+	ok &= rejects(file.substr(0, file.size() - sizeof(double)), "Truncated");
+	ok &= rejects(file + std::string(sizeof(double), '\0'), "Extended");
+	ok &= rejects(file.substr(header), "Headerless");
+	ok &= rejects(std::string(header, '\0') + file.substr(header), "Unfinished");
+	ok &= rejects(file.substr(0, header/2), "Too short");
+	std::remove(filename);
+
+	MappedDistances missing(filename);
+	std::cout << "Missing: " << (missing.valid() ? "opened" : missing.error()) << std::endl;
+	ok &= !missing.valid();
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#include <topology/rips.h>
+#include <topology/simplex.h>
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+// Checks that Rips::generate_sorted() reports the same simplices as generate(), with the same values,
+// in the filtration order: by value, and by dimension among the simplices with the same value
+
+struct Distances
+{
+	typedef			unsigned		IndexType;
+	typedef			double			DistanceType;
+
+					Distances(const std::vector<double>& points, size_t dimension):
+						points_(points), dimension_(dimension)					{}
+
+	DistanceType	operator()(IndexType a, IndexType b) const
+	{
+		double s = 0;
+		for (size_t k = 0; k < dimension_; ++k)
+		{
+			double d = points_[a*dimension_ + k] - points_[b*dimension_ + k];
+			s += d*d;
+		}
+		return std::sqrt(s);
+	}
+
+	size_t			size() const											{ return points_.size()/dimension_; }
+	IndexType		begin() const											{ return 0; }
+	IndexType		end() const												{ return size(); }
+
+	const std::vector<double>&	points_;
+	size_t						dimension_;
+};
+
+typedef			Rips<Distances>						Generator;
+typedef			Generator::Simplex					Smplx;
+typedef			Generator::View						View;
+
+struct Entry
+{
+	double					value;
+	Dimension				dimension;
+	std::vector<unsigned>	vertices;
+
+	bool			operator<(const Entry& other) const
+	{
+		if (value != other.value)			return value < other.value;
+		if (dimension != other.dimension)	return dimension < other.dimension;
+		return vertices < other.vertices;
+	}
+	bool			operator==(const Entry& other) const
+	{ return value == other.value && dimension == other.dimension && vertices == other.vertices; }
+};
+
+struct GenerateFunctor
+{
+					GenerateFunctor(std::vector<Entry>& entries, const Distances& distances):
+						entries_(entries), eval_(distances)						{}
+
+	void			operator()(const Smplx& s) const
+	{
+		Entry e = { eval_(s), s.dimension(), std::vector<unsigned>(s.vertices().begin(), s.vertices().end()) };
+		entries_.push_back(e);
+	}
+
+	std::vector<Entry>&		entries_;
+	Generator::Evaluator	eval_;
+};
+
+struct SortedFunctor
+{
+					SortedFunctor(std::vector<Entry>& entries):
+						entries_(entries)										{}
+
+	void			operator()(const View& v, double value) const
+	{
+		Entry e = { value, v.dimension(), std::vector<unsigned>(v.begin(), v.end()) };
+		entries_.push_back(e);
+	}
+
+	std::vector<Entry>&		entries_;
+};
+
+int main()
+{
+	const size_t n = 200, dimension = 3;
+	const double max = .3;
+
+	std::vector<double> points(n*dimension);
+	srand(1);
+	for (size_t i = 0; i < points.size(); ++i)
+		points[i] = rand()/double(RAND_MAX);
+
+	Distances	distances(points, dimension);
+	Generator	rips(distances);
+
+	std::vector<Entry> expected, sorted;
+	rips.generate(3, max, GenerateFunctor(expected, distances));
+	rips.generate_sorted(3, max, SortedFunctor(sorted));
+
+	std::cout << "Simplices: " << expected.size() << std::endl;
+
+	for (size_t i = 0; i < sorted.size(); ++i)
+	{
+		if (!std::is_sorted(sorted[i].vertices.begin(), sorted[i].vertices.end()))
+		{
+			std::cout << "Unsorted vertices of simplex " << i << std::endl;
+			return 1;
+		}
+		if (i > 0 && (sorted[i].value < sorted[i-1].value ||
+					  (sorted[i].value == sorted[i-1].value && sorted[i].dimension < sorted[i-1].dimension)))
+		{
+			std::cout << "Simplex " << i << " is out of the filtration order" << std::endl;
+			return 1;
+		}
+	}
+
+	// The ties can come in any order, so compare the sorted sequences
+	std::sort(expected.begin(), expected.end());
+	std::sort(sorted.begin(), sorted.end());
+	if (expected.size() != sorted.size() || !std::equal(expected.begin(), expected.end(), sorted.begin()))
+	{
+		std::cout << "generate_sorted() reports different simplices (" << sorted.size() << ") "
+				  << "than generate() (" << expected.size() << ")" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Same simplices in the filtration order" << std::endl;
+	return 0;
+}
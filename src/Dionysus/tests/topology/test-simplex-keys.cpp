@@ -0,0 +1,98 @@
+#include <topology/simplex-key.h>
+#include <topology/simplex.h>
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+// Checks that SimplexKeys numbers the simplices of every dimension by 0, 1, ..., C(n, d+1) - 1,
+// that vertices() inverts key(), and that boundary() gives the keys of the facets in the order of
+// Simplex::BoundaryIterator
+
+typedef			Simplex<unsigned>					Smplx;
+typedef			SimplexKeys::Key					Key;
+
+// Advances the sorted vertices to the next (d+1)-subset of [0, n) in the lexicographic order
+bool next_subset(std::vector<unsigned>& v, unsigned n)
+{
+	int i = v.size() - 1;
+	while (i >= 0 && v[i] == n - v.size() + i)
+		--i;
+	if (i < 0)
+		return false;
+	++v[i];
+	for (size_t j = i + 1; j < v.size(); ++j)
+		v[j] = v[j-1] + 1;
+	return true;
+}
+
+int main()
+{
+	const unsigned	n = 20;
+	const Dimension	max_dim = 3;
+
+	SimplexKeys keys(n, max_dim);
+
+	if (!SimplexKeys::fits(n, max_dim) || SimplexKeys::fits(1000000, 5))
+	{
+		std::cout << "fits() is wrong" << std::endl;
+		return 1;
+	}
+
+	for (Dimension d = 0; d <= max_dim; ++d)
+	{
+		std::vector<unsigned> v(d + 1);
+		for (Dimension i = 0; i <= d; ++i)
+			v[i] = i;
+
+		std::vector<Key> all;
+		do
+		{
+			Key k = keys.key(v.begin(), v.end());
+			all.push_back(k);
+
+			std::vector<unsigned> u(d + 1);
+			keys.vertices(k, d, u.begin());
+			if (u != v)
+			{
+				std::cout << "vertices() does not invert key() " << k << " in dimension " << d << std::endl;
+				return 1;
+			}
+
+			std::vector<Key> facets;
+			keys.boundary(v.begin(), v.end(), std::back_inserter(facets));
+			Smplx s(v.begin(), v.end());
+			size_t i = 0;
+			for (Smplx::BoundaryIterator cur = s.boundary_begin(); cur != s.boundary_end(); ++cur, ++i)
+			{
+				const Smplx& facet = *cur;
+				if (i >= facets.size() || facets[i] != keys.key(facet.vertices().begin(), facet.vertices().end()))
+				{
+					std::cout << "Wrong key of facet " << i << " of " << s << std::endl;
+					return 1;
+				}
+			}
+			if (i != facets.size())
+			{
+				std::cout << "Wrong number of facets of " << s << std::endl;
+				return 1;
+			}
+		} while (next_subset(v, n));
+
+		std::sort(all.begin(), all.end());
+		for (size_t i = 0; i < all.size(); ++i)
+			if (all[i] != i)
+			{
+				std::cout << "Keys of dimension " << d << " are not 0, ..., " << all.size() - 1 << std::endl;
+				return 1;
+			}
+		if (all.size() != keys.binomial(n, d + 1))
+		{
+			std::cout << "Wrong number of simplices of dimension " << d << std::endl;
+			return 1;
+		}
+		std::cout << "Dimension " << d << ": " << all.size() << " keys" << std::endl;
+	}
+
+	return 0;
+}
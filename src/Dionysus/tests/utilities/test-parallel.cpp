@@ -0,0 +1,91 @@
+#include <utilities/parallel.h>
+
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
+
+// Checks that parallel_for() calls the task for every index, and that an exception thrown by a task
+// (on a worker thread, or on the calling thread, worker 0) reaches the caller once all the threads are joined
+
+struct CountTask
+{
+					CountTask(size_t n): counts(n, 0)				{}
+
+	void			operator()(size_t i, unsigned)					{ ++counts[i]; }
+
+	std::vector<int>	counts;
+};
+
+// Throws on the first call on the calling thread (worker 0), or on one of the other workers; the calls on the other side
+// wait for it, so that neither side does all the tasks before the other one gets any
+struct ThrowingTask
+{
+					ThrowingTask(bool on_caller): on_caller_(on_caller), calls(0), thrown(false)	{}
+
+	void			operator()(size_t, unsigned w)
+	{
+		bool thrower = (w == 0) == on_caller_;
+		{
+			boost::lock_guard<boost::mutex> lock(mutex_);
+			++calls;
+			if (thrower) thrown = true;
+		}
+		if (thrower)
+			throw std::runtime_error("bad index");
+		while (!has_thrown())
+			boost::this_thread::yield();
+	}
+
+	bool			has_thrown()
+	{
+		boost::lock_guard<boost::mutex> lock(mutex_);
+		return thrown;
+	}
+
+	bool			on_caller_;
+	size_t			calls;
+	bool			thrown;
+	boost::mutex	mutex_;
+};
+
+bool check_throw(size_t n, unsigned threads, bool on_caller)
+{
+	ThrowingTask task(on_caller);
+	try
+	{
+		parallel_for(n, task, threads);
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cout << threads << " threads, thrown on " << (on_caller ? "the calling thread" : "a worker") << ": caught \""
+				  << e.what() << "\" after " << task.calls << " of " << n << " calls" << std::endl;
+		return true;
+	}
+	std::cout << threads << " threads, thrown on " << (on_caller ? "the calling thread" : "a worker") << ": NOT CAUGHT" << std::endl;
+	return false;
+}
+
+int main()
+{
+	const size_t n = 10000;
+
+	CountTask count(n);
+	parallel_for(n, count, 4);
+	for (size_t i = 0; i < n; ++i)
+		if (count.counts[i] != 1)
+		{
+			std::cout << "Task " << i << " called " << count.counts[i] << " times" << std::endl;
+			return 1;
+		}
+
+	bool ok = true;
+	ok &= check_throw(n, 1, true);
+	ok &= check_throw(n, 4, true);
+	ok &= check_throw(n, 4, false);
+	ok &= check_throw(n, 16, false);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include <utilities/pool.h>
+
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+
+// Checks that the objects of a Pool are destroyed exactly once, also when the copy constructor throws
+// (the slot of the failed copy must not be destroyed with the pool)
+
+static int alive = 0;
+
+struct Counted
+{
+					Counted(int v, bool throws = false): value(v), throws_on_copy(throws)		{ ++alive; }
+					Counted(const Counted& other): value(other.value), throws_on_copy(other.throws_on_copy)
+	{
+		if (throws_on_copy)
+			throw std::runtime_error("copy");
+		++alive;
+	}
+					~Counted()																	{ --alive; }
+
+	int				value;
+	bool			throws_on_copy;
+};
+
+int main()
+{
+	{
+		Pool<Counted>			pool(8);
+		std::vector<Counted*>	objects;
+		Counted					bad(-1, true);
+		int						thrown = 0;
+		for (int i = 0; i < 100; ++i)
+		{
+			objects.push_back(pool.construct(Counted(i)));
+			try
+			{
+				pool.construct(bad);
+			}
+			catch (const std::runtime_error&)
+			{
+				++thrown;
+			}
+			if (i % 3 == 0)
+			{
+				pool.destroy(objects.back());
+				objects.pop_back();
+			}
+		}
+
+		for (size_t i = 0; i < objects.size(); ++i)
+			if (objects[i]->value % 3 == 0)
+			{
+				std::cout << "Object " << i << " was overwritten" << std::endl;
+				return 1;
+			}
+		std::cout << "Thrown " << thrown << " times, " << alive << " objects alive (" << objects.size() << " in the pool)" << std::endl;
+	}
+
+	std::cout << alive << " objects alive after the pool is destroyed" << std::endl;
+	return alive == 0 ? 0 : 1;
+}
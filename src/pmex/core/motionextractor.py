@@ -20,6 +20,8 @@ from pmex.core.sco import SimplicialComplexOperator
 from pmex.core.utilitary import velocityAcceleration
 from pmex.regression.harmonicregression import HarmonicRegression 
 from pmex.regression.linearharmonicregression import LinearHarmonicRegression
+from pmex.regression.sharedfit import SharedFit
+from pmex.regression.spectralfit import SpectralFit
 import math
 
 from numpy import pi, sin
@@ -38,7 +40,7 @@ class MotionExtractor():
     
     locations= None
     
-    def __init__(self, points_radians,distance,delay_embedding=0, locations=None,prime=11):
+    def __init__(self, points_radians,distance,delay_embedding=0, locations=None,prime=11,period=None,distances_file=None):
            
         points = points_radians
           
@@ -52,7 +54,9 @@ class MotionExtractor():
         self.positions_radians = [points_radians[i] for i in range(0,len(delay_embedded_point))]
         self.positions = [points[i] for i in range(0,len(delay_embedded_point))]
 
-        self.compop = SimplicialComplexOperator(delay_embedded_point,dmax=distance,prime=prime)
+        # with a period (2 pi for the Euler angles in radians), the angles are compared the shorter way around
+        # with a distances_file, the distances of the (embedded) points are kept on disk and reused by later runs
+        self.compop = SimplicialComplexOperator(delay_embedded_point,dmax=distance,prime=prime,periods=period,distances_file=distances_file)
         self.locations = [locations[i] for i in range(0,len(delay_embedded_point))]
    
     def getPoints(self):
@@ -67,7 +71,7 @@ class MotionExtractor():
     def getCocycleLength(self,index):
         return self.compop.getCocycleLength(index)
     
-    def getPeriodicMotion(self, cocycle_index, cloud_label,useVelocity=True,useAcceleration=True,accuracy=4,jointRegressionModel = HarmonicRegression(20), translationRegressionModels=None):
+    def getPeriodicMotion(self, cocycle_index, cloud_label,useVelocity=True,useAcceleration=True,accuracy=4,jointRegressionModel = HarmonicRegression(20), translationRegressionModels=None, spectral=True):
         cycle_map = self.compop.getCircularMapping(cocycle_index)
         V = MotionExtractor.uniformlyDistributeSamples(cycle_map)
         ccluw = MotionExtractor.unwrap_simple(V)
@@ -94,81 +98,36 @@ class MotionExtractor():
             tList = tList[::-1] #reverse for negative slope
 
         t = ccluw
-        dt = ccluw
-        ddt = ccluw
+        dt = ccluw if useVelocity else []
+        ddt = ccluw if useAcceleration else []
         
-        for d in range(0, D):
-            percentage = d/(D+len(out_locations))
-            sys.stdout.write('\r {:.2f}%'.format(100*percentage))
-            sys.stdout.flush()       
-            
-            X = [p[d] for p in positions]
-            XDelta = []
-            XAcc = []
-            TDelta = []
-            TAcc = []
-                
-            if useVelocity:
-                XDelta = [p[d] for p in velocities]
-                TDelta = dt
-                
-            if useAcceleration:
-                XAcc = [p[d] for p in accelerations]
-                TAcc = ddt
-    
-            if(numpy.var(X) > 0):
-                
-                s, resP, _, _  = MotionExtractor.fitPoints(tList, t, X, [], [], [], [],jointRegressionModel, 1, 1,1)#velWeight, accWeight)
-                _, _, resV, _  = MotionExtractor.fitPoints(tList, [], [], TDelta, XDelta, [], [],jointRegressionModel, 1, 1,1)#velWeight, accWeight)
-                _, _, _, resA  = MotionExtractor.fitPoints(tList, [],[], [], [], TAcc, XAcc,jointRegressionModel, 1, 1,1)#velWeight, accWeight)
-
-                sigmaP = numpy.sqrt(numpy.sum(numpy.power(resP,2))/len(t))
-                sigmaV = numpy.sqrt(numpy.sum(numpy.power(resV,2))/len(TDelta))
-                sigmaA = numpy.sqrt(numpy.sum(numpy.power(resA,2))/len(TAcc))
-    
-                s, resP, resV, resA  = MotionExtractor.fitPoints(tList,t, X, TDelta, XDelta, TAcc, XAcc,jointRegressionModel, 1, sigmaP/sigmaV, sigmaP/sigmaA)#velWeight, accWeight)
-
-                skeletons[0][d] = s
-            else:
-                skeletons[0][d] = numpy.array(len(tList)*[numpy.mean(X)])
+        # the joint channels share the phases and the model, so they are fitted together
+        X = numpy.array(positions, dtype=float)
+        XDelta = numpy.array(velocities, dtype=float) if useVelocity else None
+        XAcc = numpy.array(accelerations, dtype=float) if useAcceleration else None
+        
+        for d, s in MotionExtractor.fitChannels(tList, t, X, dt, XDelta, ddt, XAcc, jointRegressionModel, range(0, D), spectral):
+            skeletons[0][d] = s
+        
+        sys.stdout.write('\r {:.2f}%'.format(100*D/(D+len(out_locations))))
+        sys.stdout.flush()
         
         velocities, accelerations = velocityAcceleration(self.locations,time_steps,accuracy)
         
+        X = numpy.array(self.locations, dtype=float)
+        XDelta = numpy.array(velocities, dtype=float) if useVelocity else None
+        XAcc = numpy.array(accelerations, dtype=float) if useAcceleration else None
+        
+        # the translation channels with the same kind of model share its factorization
+        groups = {}
         for d in range(0, len(out_locations)):
-            percentage = (d+D)/(D+len(out_locations))
-            sys.stdout.write('\r {:.2f}%'.format(100*percentage))
-            sys.stdout.flush()
-            
-            X = [p[d] for p in self.locations]
-            XDelta = []
-            XAcc = []
-            TDelta = []
-            TAcc = []
-            
-            if useVelocity:
-                XDelta = [p[d] for p in velocities]
-                TDelta = dt
-                
-            if useAcceleration:
-                XAcc = [p[d] for p in accelerations]
-                TAcc = ddt
-
-            if(numpy.var(X) > 0):
-                s, resP, _, _  = MotionExtractor.fitPoints(tList, t, X, [], [], [], [],translationRegressionModels[d], 1, 1,1)#velWeight, accWeight)
-                _, _, resV, _  = MotionExtractor.fitPoints(tList, [], [], TDelta, XDelta, [], [],translationRegressionModels[d], 1, 1,1)#velWeight, accWeight)
-                _, _, _, resA  = MotionExtractor.fitPoints(tList, [],[], [], [], TAcc, XAcc,translationRegressionModels[d], 1, 1,1)#velWeight, accWeight)
-
-                sigmaP = numpy.sqrt(numpy.sum(numpy.power(resP,2))/len(t))
-                sigmaV = numpy.sqrt(numpy.sum(numpy.power(resV,2))/len(TDelta))
-                sigmaA = numpy.sqrt(numpy.sum(numpy.power(resA,2))/len(TAcc))
-                
-                s, resP, resV, resA = MotionExtractor.fitPoints(tList, t, X,TDelta, XDelta, TAcc, XAcc, translationRegressionModels[d], 1, sigmaP/sigmaV, sigmaP/sigmaA) 
-                
-                out_locations[d] = s #- min(s)
-            else:
-                s = numpy.array(len(tList)*[numpy.mean(X)])
-                out_locations[d] = s 
-
+            model = translationRegressionModels[d]
+            groups.setdefault((type(model), getattr(model, 'model_complexity', id(model))), []).append(d)
+        
+        for channels in groups.values():
+            for d, s in MotionExtractor.fitChannels(tList, t, X, dt, XDelta, ddt, XAcc, translationRegressionModels[channels[0]], channels, spectral):
+                out_locations[d] = s
+        
         print('\r {:.2f}%'.format(100))
         
         return skeletons,len(skeletons)*[out_locations]
@@ -195,42 +154,44 @@ class MotionExtractor():
         return V
 
     @staticmethod
-    def fitPoints(sampledT, tList, yList, dTList, dYList, ddTList, ddYList, regressionModel, posWeights, velWeights, accWeights):
-
-        #import statsmodels.stats.diagnostic as smdiag
-        
-        #import statsmodels.api as sm
-        #import statsmodels.robust.norms as smnorm
-        pos = [yList[i] * posWeights for i in range(0, len(yList))]
-        
-        vel = [dYList[i] * velWeights for i in range(0, len(dYList))]
-        acc = [ddYList[i] * accWeights for i in range(0, len(ddYList))]
-        b = numpy.array(pos + vel + acc)
-        
-        rows = [ posWeights * numpy.array(regressionModel.positionModel(tList[i])) for i in range(0, len(tList))]
-        deltaRows = [ velWeights * numpy.array(regressionModel.velocityModel(dTList[i])) for i in range(0, len(dYList))]
-        ddRows = [accWeights * numpy.array(regressionModel.accelerationModel(ddTList[i])) for i in range(0, len(ddYList))]
-        
-        A = numpy.matrix(rows + deltaRows + ddRows)
-        
-        if len(b) == 0:
-            return ([],[],[],[])
-        (w, residuals, rank, sing_vals) = numpy.linalg.lstsq(A, b)
+    def fitChannels(sampledT, tList, Y, dTList, dY, ddTList, ddY, regressionModel, channels, spectral=False):
+        # fits the columns channels of Y (positions at tList), dY (velocities at dTList) and ddY (accelerations
+        # at ddTList; either can be None) jointly, every channel on its own: the separate fits of every block give
+        # the weights of the velocities and the accelerations, sigmaP/sigmaV and sigmaP/sigmaA, for the joint one.
+        # The design matrix is factorized once for all the channels. Yields (channel, positions at sampledT); the
+        # constant channels get their mean. With spectral, the positions alone are fitted with SpectralFit when it applies.
+        varying = [d for d in channels if numpy.var(Y[:, d]) > 0]
+        for d in channels:
+            if d not in varying:
+                yield d, numpy.array(len(sampledT)*[numpy.mean(Y[:, d])])
+        if len(varying) == 0:
+            return
+
+        if spectral and dY is None and ddY is None and SpectralFit.applies(regressionModel, tList):
+            fit = SpectralFit(regressionModel, tList)
+            positions = fit.evaluate(sampledT, fit.fit([Y[:, varying], None, None]))
+            for i, d in enumerate(varying):
+                yield d, positions[:, i]
+            return
+
+        fit = SharedFit(regressionModel, tList, dTList if dY is not None else [], ddTList if ddY is not None else [])
+        values = [Y[:, varying], None if dY is None else dY[:, varying], None if ddY is None else ddY[:, varying]]
+
+        sigmas = []
+        for block in range(0, 3):
+            if values[block] is None:
+                sigmas.append(None)
+                continue
+            separate = [None, None, None]
+            separate[block] = values[block]
+            residuals = values[block] - fit.predict(block, fit.fit(separate))
+            sigmas.append(numpy.sqrt(numpy.sum(numpy.power(residuals, 2), axis=0) / len(residuals)))
+
+        weights = (1, 1 if sigmas[1] is None else sigmas[0]/sigmas[1], 1 if sigmas[2] is None else sigmas[0]/sigmas[2])
+        positions = fit.evaluate(sampledT, fit.fit(values, weights))
+        for i, d in enumerate(varying):
+            yield d, positions[:, i]
 
-        #model = sm.RLM(b, A, M=smnorm.RamsayE())
-        #model = sm.OLS(b, A)
-        #result = model.fit()
-
-        #w = result.params
-
-        positions = [ numpy.sum(regressionModel.positionModel(t, w)) for t in sampledT]
-        
-        residuals1 = posWeights*(numpy.array(yList) - numpy.array([ numpy.sum(regressionModel.positionModel(t, w)) for t in tList]))
-        residuals2 = velWeights*(numpy.array(dYList) - numpy.array([ numpy.sum(regressionModel.velocityModel(t, w)) for t in dTList]))
-        residuals3 = accWeights*(numpy.array(ddYList) - numpy.array([ numpy.sum(regressionModel.accelerationModel(t, w)) for t in ddTList]))
-
-        return (positions, residuals1,residuals2,residuals3)            
-        
     @staticmethod
     def delay_embbed(points,n):
         D = len(points[0])
@@ -16,71 +16,68 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 """
 
-from pmex.dionysus import data_dim_cmp, PairwiseDistances, Rips, Filtration, CohomologyPersistence, ExplicitDistances,DynamicPersistenceChains
+from pmex.dionysus import ArrayDistances, Rips, Filtration, CohomologyPersistence, CircularCoordinates
 
 import numpy
 
-from    cvxopt          import spmatrix, matrix
-from    cvxopt.blas     import copy
-from    pmex.core.lsqr  import lsqr
-
-import time
-import sys
+import os
 
 class SimplicialComplexOperator():
     
     ccls = None
     simplices = None
     prime = 47
-    cclOrders = None
+    coordinates = None
+    mappings = None
+    statistics = None
     
-    def __init__(self, points, skeleton = 2, dmax = float('inf'),prime=47):
+    def __init__(self, points, skeleton = 2, dmax = float('inf'),prime=47,periods=None,distances_file=None):
         
         self.simplices = Filtration()
         self.prime = prime
         self.ccls = []
+        self.coordinates = None                             # (death, CircularCoordinates below it), built on demand
+        self.mappings = {}                                  # circular maps by cocycle index
+        self.statistics = (0, 0.0)                          # iterations and seconds of the last smoothing
         
-        distances = PairwiseDistances(points)
-
-        distances = ExplicitDistances(distances)           # speeds up generation of the Rips complex at the expense of memory usage
+        # evaluated in C++, without calls into Python; periods (one for all the coordinates, or one per coordinate,
+        # 0 for the Euclidean ones) make the coordinates angles, whose differences wrap around
+        distances = ArrayDistances(numpy.asarray(points, dtype=float), periods)
+
+        # with a distances_file, the distances are written once, and later runs on the same points (e.g., with another
+        # dmax) map the file instead of computing them again, so they need not fit in memory; the key (a hash of the
+        # points and the periods) tells whether the file is of these points, and otherwise it is written anew; so is a file
+        # that does not open (e.g., one left unfinished by an interrupted run, whose header is written last)
+        if distances_file is not None:
+            try:
+                stored = ArrayDistances.open(distances_file) if os.path.exists(distances_file) else None
+            except IOError:
+                stored = None
+            if stored is None or stored.key() != distances.key():
+                stored = None                               # unmapped before the file is overwritten
+                distances.save(distances_file)
+                stored = ArrayDistances.open(distances_file)
+            distances = stored
             
         rips = Rips(distances)
             
         self.prime = prime
             
-        rips.generate(skeleton, dmax, self.simplices.append)
-
-        for s in self.simplices: 
-            s.data = rips.eval(s)
+        # simplices come sorted by (value, dimension), so the filtration needs no sort
+        rips.generate_sorted(skeleton, dmax, self.simplices.append)
 
+        # the whole filtration goes through the persistence in one native call; the cocycles of dimension
+        # skeleton - 1 come back as the filtration positions of their simplices and their coefficients
+        pairs, offsets, positions, coefficients = CohomologyPersistence.add_filtration(self.simplices, prime, skeleton)
+        pairs, offsets = numpy.asarray(pairs), numpy.asarray(offsets)
+        positions, coefficients = numpy.asarray(positions), numpy.asarray(coefficients)
 
-        self.simplices.sort(data_dim_cmp)
-
-        ch = CohomologyPersistence(prime)
-        complex = {}
-        internalToExternalMap = {}
-
-        for j, s in enumerate(self.simplices):
-            percentage = j/len(self.simplices)
-            sys.stdout.write('\r {:.2f}%'.format(100*percentage))
-            sys.stdout.flush()
-            
-            i, d, ccl = ch.add([complex[sb] for sb in s.boundary], (s.dimension(), s.data), store=(s.dimension() < skeleton))
-            complex[s] = i
+        for i, (dimension, birth, death) in enumerate(pairs):
+            if dimension == skeleton - 1:
+                orders = positions[offsets[i]:offsets[i+1]].tolist()
+                ccl = coefficients[offsets[i]:offsets[i+1]].tolist()
+                self.ccls.append((ccl, birth, min(death, dmax), orders))
 
-            internalToExternalMap[i.order] = j
-
-            if d != None and d[0] == skeleton - 1 and not((d[1] - s.data) == 0):
-                orders = [e.si.order for e in ccl]
-                self.ccls.append((ccl, d[1], s.data,orders))
-
-        print('\r {:.2f}%'.format(100))
-    
-        for ccl in ch:
-            if ccl.birth[0] == skeleton - 1:
-                orders = [e.si.order for e in ccl]
-                self.ccls.append((ccl, ccl.birth[1],dmax, orders))
-                            
         self.ccls.sort(key=lambda tup : tup[2] - tup[1] , reverse=True)
 
     def getCocycleCount(self):
@@ -101,81 +98,31 @@ class SimplicialComplexOperator():
         return self.simplices
     
     def getCircularMapping(self, cocycle_index):
-
-        ccl = self.ccls[cocycle_index][0]
-        death = self.ccls[cocycle_index][2]
-        orders = self.ccls[cocycle_index][3]
-        coefficients = [self.normalized(e.coefficient) for e in ccl]
-        ccl_list = [(coefficients[i],orders[i]) for i in range(0,len(orders))]
-       
-        cycle_map = self.smooth(death, ccl_list)
-        cycle_map = numpy.mod(cycle_map, 1.0)
-
-        return cycle_map
-
-    def normalized(self,coefficient):
-        if coefficient > self.prime / 2:
-            return coefficient - self.prime
-        return coefficient
-        
-    def smooth(self,death, cocycle):
-        coefficient = []
-        coface_indices = []
-        face_indices = []
-        
-        for i, s in enumerate(self.simplices):
-            #print(s.data, " ", death)
-            if s.data < death:
-                if s.dimension() <= 2:
-                    c = 1
-                    for sb in s.boundary:
-                        j = self.simplices(sb)
-                        coefficient.append(c)
-                        coface_indices.append(i)
-                        face_indices.append(j)
-                        c *= -1
-            else:
-                break
-    
-        dimension = max(max(coface_indices), max(face_indices)) + 1
-        
-        D = spmatrix(coefficient, coface_indices, face_indices, (dimension, dimension))
-    
-        cocycle = [zz for zz in cocycle if zz[1] < dimension]
-    
-        z = spmatrix([zz[0] for zz in cocycle],
-                     [zz[1] for zz in cocycle],
-                     [0     for zz in cocycle], (dimension, 1))
-    
-        v1 = D * z
-     
-        if bool(D * D):
-            raise Exception('D^2 is not 0')
-        if bool(v1):
-            raise Exception('Expected a cocycle as input')
-        z = matrix(z)
-    
-        def Dfun(x, y, trans='N'):
-            if trans == 'N':
-                copy(D * x, y)
-            elif trans == 'T':
-                copy(D.T * x, y)
-            else:
-                assert False, "Unexpected trans parameter"
-    
-        tol = 1e-10
-        solution = lsqr(Dfun, matrix(z), show=False, atol=tol, btol=tol, itnlim=None)
-        z_smooth = z - D * solution[0]
-    
-        if not (sum((D * z_smooth) ** 2) < tol and sum((D.T * z_smooth) ** 2) < tol):
-            raise Exception("Expected a harmonic cocycle: %f %f" % (sum((D*z_smooth)**2), sum((D.T*z_smooth)**2)))
-            
-        values = []
-        vertices = ((i, s) for (i, s) in enumerate(self.simplices) if s.dimension() == 0)
-        for i, s in vertices:
-            v = [v for v in s.vertices][0]
-            if v >= len(values):
-                values.extend((None for i in range(len(values), v + 1)))
-            values[v] = solution[0][i]
-    
-        return values
+        return self.getCircularMappings([cocycle_index])[0]
+
+    def getCircularMappings(self, cocycle_indices, precondition=True):
+        # the cocycles not computed yet are smoothed together, each in the complex below its death
+        pending = [i for i in set(cocycle_indices) if i not in self.mappings]
+        if pending:
+            cycle_maps = self.smooth([(self.ccls[i][3], self.ccls[i][0], self.ccls[i][2]) for i in pending], precondition)
+            for i, cycle_map in zip(pending, cycle_maps):
+                self.mappings[i] = numpy.mod(cycle_map, 1.0)
+                self.mappings[i].flags.writeable = False    # shared by all the callers
+
+        return [self.mappings[i] for i in cocycle_indices]
+
+    def getSmoothingStatistics(self):
+        return self.statistics
+
+    def smooth(self, cocycles, precondition=True):
+        # the coboundaries are built once, for the complex below the largest death (the complex below any smaller death
+        # is its prefix), and the least squares for the harmonic cocycles are native; the coefficients are lifted from
+        # Z_prime into (-prime/2, prime/2] on the way; the conjugate gradient is preconditioned with the incomplete
+        # Cholesky factorization of the graph Laplacian unless precondition is False
+        death = max(c[2] for c in cocycles)
+        if self.coordinates is None or self.coordinates[0] < death:
+            self.coordinates = (death, CircularCoordinates(self.simplices, death))
+        coordinates = self.coordinates[1]
+        cycle_maps = numpy.asarray(coordinates.smooth_all(cocycles, self.prime, precondition))
+        self.statistics = (coordinates.iterations, coordinates.time)
+        return cycle_maps
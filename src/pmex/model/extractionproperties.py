@@ -33,10 +33,12 @@ class ExtractionProperties(bpy.types.PropertyGroup):
 
     #out_frame_rate = bpy.props.IntProperty(name="Frame rate", default=120, min=1)
     cycels = bpy.props.IntProperty(name="Number of output actions", default=1, min=1)
-    prime = bpy.props.IntProperty(name="Prime", default=11, min=3)
+    prime = bpy.props.IntProperty(name="Prime", default=11, min=3, max=65521)
     
     enable_advanced = bpy.props.BoolProperty(name="Advanced options", default=False)
     delay_embedding =  bpy.props.IntProperty(name="Delay embedding", default=2, min=0)
+    use_angular_distance = bpy.props.BoolProperty(name="Angular distance", description="Measure the distances between the rotations with the angles wrapped around, so a turn from pi to -pi is short", default=False)
+    distances_file = bpy.props.StringProperty(name="Distances file", description="Keep the distances between the frames in this file and reuse them in later runs on the same frames (e.g., with another maximum distance); empty to compute them every time", default="", subtype='FILE_PATH')
     
     use_positions = bpy.props.BoolProperty(name="Compute translation", default=True)
     use_positions_X = bpy.props.BoolProperty(name="X", default=True)
@@ -60,6 +62,7 @@ class ExtractionProperties(bpy.types.PropertyGroup):
     accuracy = bpy.props.IntProperty(name="Derivative accuracy", default=4, min=1, max=4)
     use_velocity = bpy.props.BoolProperty(name="Use joint velocity", default=True)
     use_acceleration = bpy.props.BoolProperty(name="Use joint acceleration", default=True)
+    use_spectral_fit = bpy.props.BoolProperty(name="Spectral fit", description="Fit the periodic models with the FFT when neither velocity nor acceleration is used", default=True)
     
     model_complexity = bpy.props.IntProperty(name="Joint model complexity", default=20, min=1)
     translation_model_complexity = bpy.props.IntProperty(name="Translation model complexity", default=20, min=1)
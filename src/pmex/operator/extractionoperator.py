@@ -54,11 +54,14 @@ class ExtractionOperator(bpy.types.Operator):
             paths = data_paths + loc_paths
 
             delay_embedding = 0
+            distances_file = None
             if options.enable_advanced:
                 delay_embedding = options.delay_embedding
+                if options.distances_file:
+                    distances_file = bpy.path.abspath(options.distances_file)
 
             print(time.asctime(),"Step 1 of 2. Constructing simplicial complex and cocycels.")
-            motext = MotionExtractor(points,options.dmax,delay_embedding,locations=locations,prime=options.prime)
+            motext = MotionExtractor(points,options.dmax,delay_embedding,locations=locations,prime=options.prime,period=2*numpy.pi if options.use_angular_distance else None,distances_file=distances_file)
             print(time.asctime(),"Complex constructed.")
             if options.enable_advanced and options.manual_cocycle_selection:
                 
@@ -79,10 +82,13 @@ class ExtractionOperator(bpy.types.Operator):
             skeletons = []
 
             print(time.asctime(),"Step 2 of 2. Constructing actions.")
+            motext.getSCO().getCircularMappings(indices)        # smooths the selected cocycles together, the calls below hit the cache
+            if len(indices) > 0:
+                print(time.asctime(),"Smoothed %d cocycles in %d iterations (%.3f s)." % ((len(indices),) + motext.getSCO().getSmoothingStatistics()))
             for i in range(0,len(indices)):
                 print(time.asctime(),"Constructing action",i+1,"of",len(indices),"for cocycle of length","%.3f" % motext.getCocycleLength(i))
                 #try:
-                skeleton, loc = motext.getPeriodicMotion(indices[i],action.name,options.use_velocity,options.use_acceleration,options.accuracy,HarmonicRegression(options.model_complexity),loc_models)
+                skeleton, loc = motext.getPeriodicMotion(indices[i],action.name,options.use_velocity,options.use_acceleration,options.accuracy,HarmonicRegression(options.model_complexity),loc_models,options.use_spectral_fit)
                 for j in range(0,len(skeleton)):
                     skeletons.append(skeleton[j] + loc[j])
                     if options.plot_pca:
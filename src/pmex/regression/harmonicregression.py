@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 """
 
 from pmex.regression.regressionmodel import RegressionModel
+from pmex.dionysus import harmonics, harmonics_combination
 import numpy
 import itertools
 from numpy import cos, sin, pi
@@ -57,4 +58,20 @@ class HarmonicRegression(RegressionModel):
                -coefficients[2 * i + 1] * pow(2 * pi * self.frequencies[i], 2) * numpy.cos(self.frequencies[i] * 2 * pi * x))
                for i in range(0, self.model_complexity))) 
         return list(itertools.chain.from_iterable((harmonic_part,[0])))
-    
+
+    def columns(self, x, derivative=0):
+        # the harmonics (sin, cos of every frequency) come from the native angle-addition recurrence, and the constant follows
+        constant = numpy.full((len(x), 1), 1.0 if derivative == 0 else 0.0)
+        return numpy.hstack((numpy.asarray(harmonics(x, self.model_complexity, derivative)), constant))
+
+    def designMatrix(self, t, dt, ddt, weights=(1, 1, 1)):
+        blocks = [weight * self.columns(x, derivative) for x, derivative, weight in ((t, 0, weights[0]), (dt, 1, weights[1]), (ddt, 2, weights[2])) if len(x) > 0]
+        if len(blocks) == 0:
+            return numpy.zeros((0, 2 * self.model_complexity + 1))
+        return numpy.vstack(blocks)
+
+    def evaluate(self, t, coefficients, derivative=0):
+        values = numpy.asarray(harmonics_combination(t, self.model_complexity, coefficients, derivative))
+        if derivative == 0:
+            values = values + coefficients[-1]
+        return values
@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 """
 
 from abc import ABCMeta, abstractmethod
+import numpy
 
 class RegressionModel(metaclass=ABCMeta):
     
@@ -31,3 +32,16 @@ class RegressionModel(metaclass=ABCMeta):
     @abstractmethod
     def accelerationModel(self,x, coefficients=None):
         return 0
+
+    def designMatrix(self, t, dt, ddt, weights=(1, 1, 1)):
+        # the rows of the position model at t, the velocity model at dt and the acceleration model at ddt (each block
+        # scaled by its weight), stacked; the models with vectorized columns override this
+        rows = [weights[0] * numpy.array(self.positionModel(x)) for x in t] + \
+               [weights[1] * numpy.array(self.velocityModel(x)) for x in dt] + \
+               [weights[2] * numpy.array(self.accelerationModel(x)) for x in ddt]
+        return numpy.array(rows)
+
+    def evaluate(self, t, coefficients, derivative=0):
+        # the model with the coefficients (its velocity for derivative 1, its acceleration for derivative 2) at t
+        model = (self.positionModel, self.velocityModel, self.accelerationModel)[derivative]
+        return numpy.array([numpy.sum(model(x, coefficients)) for x in t])
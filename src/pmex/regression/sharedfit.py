@@ -0,0 +1,66 @@
+"""This is part of the Periodic Motion Extractor plugin for Blender,
+and is to be used for extracting periodic motions from motion capture data.
+Copyright (C) 2014  Magnus Raunio
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+"""
+
+import numpy
+
+class SharedFit():
+    """Least squares fits of several channels (e.g. all the joint angles) against one regression model at the same
+    samples. Every block of the design matrix (the positions at t, the velocities at dt, the accelerations at ddt) is
+    factorized once, A = Q S (reduced QR). Since Q has orthonormal columns, a fit with the block weights (1, wv, wa)
+    is the same as the fit of [S_P; wv S_V; wa S_A] x = [Q_P^T y; wv Q_V^T v; wa Q_A^T a], which has 3*k rows for
+    k coefficients whatever the number of samples, so changing the weights of a channel costs next to nothing."""
+
+    def __init__(self, regressionModel, t, dt, ddt):
+        self.model = regressionModel
+        self.factors = []
+        for i, x in enumerate((t, dt, ddt)):
+            if len(x) > 0:
+                samples = [[], [], []]
+                samples[i] = x
+                self.factors.append(numpy.linalg.qr(regressionModel.designMatrix(*samples)))
+            else:
+                self.factors.append(None)
+
+    def fit(self, values, weights=(1, 1, 1)):
+        # values[i] has a column per channel for the block i (None leaves the block out), and weights[i] is
+        # either one weight or a weight per channel; returns the coefficients, a column per channel
+        blocks = [i for i in range(3) if values[i] is not None and self.factors[i] is not None]
+        projected = [self.factors[i][0].T.dot(values[i]) for i in blocks]               # Q^T y for all the channels at once
+        channels = projected[0].shape[1]
+        blockWeights = [numpy.broadcast_to(numpy.asarray(weights[i], dtype=float), (channels,)) for i in blocks]
+
+        if all(numpy.all(w == w[0]) for w in blockWeights):                             # one solve for all the channels
+            S = numpy.vstack([w[0] * self.factors[i][1] for w, i in zip(blockWeights, blocks)])
+            b = numpy.vstack([w[0] * p for w, p in zip(blockWeights, projected)])
+            return numpy.linalg.lstsq(S, b, rcond=None)[0]
+
+        coefficients = numpy.empty((self.factors[blocks[0]][1].shape[1], channels))
+        for c in range(channels):
+            S = numpy.vstack([w[c] * self.factors[i][1] for w, i in zip(blockWeights, blocks)])
+            b = numpy.concatenate([w[c] * p[:, c] for w, p in zip(blockWeights, projected)])
+            coefficients[:, c] = numpy.linalg.lstsq(S, b, rcond=None)[0]
+        return coefficients
+
+    def predict(self, block, coefficients):
+        # the model of the block (0 for the positions, 1 for the velocities, 2 for the accelerations) at its samples
+        Q, S = self.factors[block]
+        return Q.dot(S.dot(coefficients))
+
+    def evaluate(self, t, coefficients):
+        # the positions at t, a column per channel
+        return self.model.designMatrix(t, [], []).dot(coefficients)
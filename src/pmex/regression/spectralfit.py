@@ -0,0 +1,73 @@
+"""This is part of the Periodic Motion Extractor plugin for Blender,
+and is to be used for extracting periodic motions from motion capture data.
+Copyright (C) 2014  Magnus Raunio
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+"""
+
+from pmex.regression.harmonicregression import HarmonicRegression
+import numpy
+
+class SpectralFit():
+    """Least squares fits of the positions of several channels to a HarmonicRegression when the phases are uniformly
+    distributed, as MotionExtractor.uniformlyDistributeSamples() makes them: modulo 1, the N phases are 0, 1/N, ...,
+    (N-1)/N in some order. The discrete harmonics are orthogonal on such a grid, so (for fewer than N/2 frequencies)
+    the least squares coefficients are the discrete Fourier coefficients of the samples sorted by the phase, and one
+    FFT per channel, O(N log N), replaces the dense least squares. The same interface as SharedFit (without the
+    velocities and the accelerations, which need the least squares)."""
+
+    def __init__(self, regressionModel, t):
+        self.model = regressionModel
+        self.order = SpectralFit.grid(t)
+
+    @staticmethod
+    def applies(regressionModel, t):
+        # whether the fit of the positions at t with regressionModel can be spectral
+        return type(regressionModel) is HarmonicRegression and 2 * regressionModel.model_complexity < len(t) \
+            and SpectralFit.grid(t) is not None
+
+    @staticmethod
+    def grid(t):
+        # the index k of the phase k/N of every sample, or None if the phases (modulo 1) are not the uniform grid
+        N = len(t)
+        if N == 0:
+            return None
+        x = numpy.mod(numpy.asarray(t, dtype=float), 1.0) * N
+        k = numpy.rint(x).astype(int)
+        if numpy.max(numpy.abs(x - k)) > 1e-6:
+            return None
+        k = numpy.mod(k, N)
+        if numpy.any(numpy.bincount(k, minlength=N) != 1):
+            return None
+        return k
+
+    def fit(self, values, weights=(1, 1, 1)):
+        # values[0] has a column per channel (the positions); returns the coefficients, a column per channel.
+        # With y sorted by the phase and F = FFT(y), the coefficient of sin(2 pi j t) is -2 Im(F_j)/N, the one
+        # of cos(2 pi j t) is 2 Re(F_j)/N, and the constant is F_0/N.
+        Y = numpy.asarray(values[0], dtype=float)
+        N, K = len(self.order), self.model.model_complexity
+        sorted_values = numpy.empty_like(Y)
+        sorted_values[self.order] = Y
+        F = numpy.fft.rfft(sorted_values, axis=0)
+
+        coefficients = numpy.empty((2 * K + 1,) + Y.shape[1:])
+        coefficients[0:2 * K:2] = -2 * F[1:K + 1].imag / N
+        coefficients[1:2 * K:2] = 2 * F[1:K + 1].real / N
+        coefficients[2 * K] = F[0].real / N
+        return coefficients
+
+    def evaluate(self, t, coefficients):
+        # the positions at t, a column per channel
+        return self.model.designMatrix(t, [], []).dot(coefficients)
@@ -49,6 +49,8 @@ class ExtractionPanel(bpy.types.Panel):
             
         if props.enable_advanced:
             inputBox.prop(props,'delay_embedding')
+            inputBox.prop(props,'use_angular_distance')
+            inputBox.prop(props,'distances_file')
             inputBox.prop(props,'prime')
 
         outputBox = layout.box()
@@ -88,6 +90,8 @@ class ExtractionPanel(bpy.types.Panel):
             outputBox.prop(props,'use_acceleration') 
             if props.use_acceleration or props.use_velocity:
                 outputBox.prop(props,'accuracy')
+            else:
+                outputBox.prop(props,'use_spectral_fit')
         
         if props.enable_advanced:
             analyticsBox = layout.box()